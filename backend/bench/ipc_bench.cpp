@@ -0,0 +1,602 @@
+#include <iostream>
+#include <sys/socket.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <cstring>
+#include <ctime>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <csignal>
+#include "../common/histogram.h"
+
+// Harness que compara pipes, sockets Unix e memória compartilhada com a mesma
+// carga: ping-pong (latência de ida e volta) e streaming (vazão), entre dois
+// processos criados com fork, para tamanhos de payload de 8 B a 4 MiB.
+
+#define CACHE_LINE_SIZE 64
+#define SHM_RING_SLOTS 4                // slots por direção no canal de memória compartilhada
+#define SHM_SPIN_LIMIT 2000             // iterações de espera ativa antes do futex
+#define SHM_PEER_CHECK_NS 100000000     // intervalo entre verificações do outro processo no futex
+#define PIPE_BUFFER_SIZE (1024 * 1024)
+#define MIN_ITERATIONS 20
+#define MAX_ITERATIONS 20000
+
+enum Mechanism {
+    MECH_PIPE,
+    MECH_SOCKET,
+    MECH_SHM
+};
+
+enum TestKind {
+    TEST_PINGPONG,
+    TEST_STREAM
+};
+
+// Opções da execução
+struct BenchConfig {
+    std::vector<Mechanism> mechanisms;
+    std::vector<TestKind> tests;
+    std::vector<size_t> sizes;
+    int producer_cpu;           // -1: sem fixação
+    int consumer_cpu;
+    uint64_t budget_bytes;      // bytes transferidos por medição (define as iterações)
+    bool csv;
+    int spin_limit;             // espera ativa do canal shm (0 quando os processos dividem uma CPU)
+    
+    BenchConfig() : producer_cpu(-1), consumer_cpu(-1), budget_bytes(64ULL * 1024 * 1024), csv(false),
+                   spin_limit(SHM_SPIN_LIMIT) {}
+};
+
+BenchConfig config;
+
+// Anel SPSC de mensagens em memória compartilhada. head é avançado pelo
+// produtor e tail pelo consumidor; ambos servem de palavra de futex.
+struct ShmRing {
+    std::atomic<uint32_t> head;
+    std::atomic<uint32_t> head_waiters;
+    char pad0[CACHE_LINE_SIZE - 2 * sizeof(std::atomic<uint32_t>)];
+    std::atomic<uint32_t> tail;
+    std::atomic<uint32_t> tail_waiters;
+    char pad1[CACHE_LINE_SIZE - 2 * sizeof(std::atomic<uint32_t>)];
+};
+
+// Canal entre os dois processos; para pipes e sockets só os descritores são usados
+struct Channel {
+    Mechanism mechanism;
+    int parent_rx, parent_tx;   // lados do processo pai (produtor)
+    int child_rx, child_tx;     // lados do processo filho (consumidor)
+    char* region;               // mapeamento compartilhado (MECH_SHM)
+    size_t region_size;
+    size_t slot_size;
+    pid_t peer;                 // outro processo da medição (MECH_SHM verifica se ainda existe)
+    bool peer_is_child;
+    bool peer_exited;           // filho já coletado por waitpid durante a espera
+    int peer_status;
+    
+    Channel() : mechanism(MECH_PIPE), parent_rx(-1), parent_tx(-1), child_rx(-1), child_tx(-1),
+               region(nullptr), region_size(0), slot_size(0), peer(0), peer_is_child(false),
+               peer_exited(false), peer_status(0) {}
+};
+
+// Função para obter tempo monotônico em nanossegundos
+uint64_t monotonicNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+const char* mechanismName(Mechanism mechanism) {
+    switch (mechanism) {
+        case MECH_PIPE: return "pipe";
+        case MECH_SOCKET: return "socket";
+        default: return "shm";
+    }
+}
+
+// Função para fixar o processo atual em uma CPU
+void pinToCpu(int cpu) {
+    if (cpu < 0) {
+        return;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (sched_setaffinity(0, sizeof(set), &set) == -1) {
+        std::cerr << "Erro ao fixar na CPU " << cpu << ": " << strerror(errno) << std::endl;
+    }
+}
+
+bool writeAll(int fd, const char* data, size_t length) {
+    while (length > 0) {
+        ssize_t n = write(fd, data, length);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        length -= n;
+    }
+    return true;
+}
+
+bool readAll(int fd, char* data, size_t length) {
+    while (length > 0) {
+        ssize_t n = read(fd, data, length);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        length -= n;
+    }
+    return true;
+}
+
+// Funções de futex sobre palavras em mapeamento compartilhado entre processos
+void futexWait(std::atomic<uint32_t>* addr, uint32_t expected, const struct timespec* timeout) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(addr), FUTEX_WAIT, expected, timeout, nullptr, 0);
+}
+
+void futexWake(std::atomic<uint32_t>* addr) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(addr), FUTEX_WAKE, INT32_MAX, nullptr, nullptr, 0);
+}
+
+// Função para verificar se o outro processo da medição ainda existe: o pai
+// coleta o filho com WNOHANG (guardando o status), o filho compara o getppid
+bool shmPeerAlive(Channel& channel) {
+    if (channel.peer_exited) {
+        return false;
+    }
+    if (!channel.peer_is_child) {
+        return getppid() == channel.peer;
+    }
+    int status = 0;
+    if (waitpid(channel.peer, &status, WNOHANG) == channel.peer) {
+        channel.peer_exited = true;
+        channel.peer_status = status;
+        return false;
+    }
+    return true;
+}
+
+// Função para esperar até que word deixe de valer current: espera ativa
+// curta e depois futex, registrando-se em waiters para que o outro lado
+// só faça a syscall de wake quando há alguém dormindo. O futex expira a cada
+// SHM_PEER_CHECK_NS para detectar a morte do outro lado (retorna false)
+bool shmWaitChange(Channel& channel, std::atomic<uint32_t>& word, std::atomic<uint32_t>& waiters,
+                   uint32_t current) {
+    for (int i = 0; i < config.spin_limit; i++) {
+        if (word.load(std::memory_order_acquire) != current) {
+            return true;
+        }
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#endif
+    }
+    struct timespec timeout;
+    timeout.tv_sec = SHM_PEER_CHECK_NS / 1000000000;
+    timeout.tv_nsec = SHM_PEER_CHECK_NS % 1000000000;
+    while (word.load(std::memory_order_acquire) == current) {
+        waiters.fetch_add(1, std::memory_order_seq_cst);
+        if (word.load(std::memory_order_seq_cst) == current) {
+            futexWait(&word, current, &timeout);
+        }
+        waiters.fetch_sub(1, std::memory_order_relaxed);
+        if (word.load(std::memory_order_acquire) == current && !shmPeerAlive(channel)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void shmPublish(std::atomic<uint32_t>& word, std::atomic<uint32_t>& waiters, uint32_t value) {
+    word.store(value, std::memory_order_seq_cst);
+    if (waiters.load(std::memory_order_seq_cst) > 0) {
+        futexWake(&word);
+    }
+}
+
+// Anel de uma direção: 0 = pai -> filho, 1 = filho -> pai
+ShmRing* shmRing(Channel& channel, int direction) {
+    size_t ring_bytes = sizeof(ShmRing) + SHM_RING_SLOTS * channel.slot_size;
+    return reinterpret_cast<ShmRing*>(channel.region + direction * ring_bytes);
+}
+
+char* shmSlot(Channel& channel, ShmRing* ring, uint32_t index) {
+    return reinterpret_cast<char*>(ring + 1) + (size_t)(index % SHM_RING_SLOTS) * channel.slot_size;
+}
+
+bool shmSend(Channel& channel, int direction, const char* data, size_t length) {
+    ShmRing* ring = shmRing(channel, direction);
+    uint32_t head = ring->head.load(std::memory_order_relaxed);
+    uint32_t tail;
+    while (head - (tail = ring->tail.load(std::memory_order_acquire)) >= SHM_RING_SLOTS) {
+        if (!shmWaitChange(channel, ring->tail, ring->tail_waiters, tail)) {
+            return false;
+        }
+    }
+    memcpy(shmSlot(channel, ring, head), data, length);
+    shmPublish(ring->head, ring->head_waiters, head + 1);
+    return true;
+}
+
+bool shmReceive(Channel& channel, int direction, char* data, size_t length) {
+    ShmRing* ring = shmRing(channel, direction);
+    uint32_t tail = ring->tail.load(std::memory_order_relaxed);
+    if (!shmWaitChange(channel, ring->head, ring->head_waiters, tail)) {
+        return false;
+    }
+    memcpy(data, shmSlot(channel, ring, tail), length);
+    shmPublish(ring->tail, ring->tail_waiters, tail + 1);
+    return true;
+}
+
+// Funções de envio/recepção independentes do mecanismo (is_parent escolhe a direção)
+bool channelSend(Channel& channel, bool is_parent, const char* data, size_t length) {
+    if (channel.mechanism == MECH_SHM) {
+        return shmSend(channel, is_parent ? 0 : 1, data, length);
+    }
+    return writeAll(is_parent ? channel.parent_tx : channel.child_tx, data, length);
+}
+
+bool channelReceive(Channel& channel, bool is_parent, char* data, size_t length) {
+    if (channel.mechanism == MECH_SHM) {
+        return shmReceive(channel, is_parent ? 1 : 0, data, length);
+    }
+    return readAll(is_parent ? channel.parent_rx : channel.child_rx, data, length);
+}
+
+// Função para criar o canal do mecanismo para mensagens de até size bytes
+bool openChannel(Channel& channel, Mechanism mechanism, size_t size) {
+    channel = Channel();
+    channel.mechanism = mechanism;
+    
+    if (mechanism == MECH_PIPE) {
+        int to_child[2], to_parent[2];
+        if (pipe(to_child) == -1 || pipe(to_parent) == -1) {
+            return false;
+        }
+        // Pipes maiores reduzem trocas de contexto com payloads grandes
+        fcntl(to_child[1], F_SETPIPE_SZ, PIPE_BUFFER_SIZE);
+        fcntl(to_parent[1], F_SETPIPE_SZ, PIPE_BUFFER_SIZE);
+        channel.parent_tx = to_child[1];
+        channel.child_rx = to_child[0];
+        channel.child_tx = to_parent[1];
+        channel.parent_rx = to_parent[0];
+        return true;
+    }
+    
+    if (mechanism == MECH_SOCKET) {
+        int fds[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == -1) {
+            return false;
+        }
+        channel.parent_tx = channel.parent_rx = fds[0];
+        channel.child_tx = channel.child_rx = fds[1];
+        return true;
+    }
+    
+    channel.slot_size = (size + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE;
+    channel.region_size = 2 * (sizeof(ShmRing) + SHM_RING_SLOTS * channel.slot_size);
+    void* region = mmap(NULL, channel.region_size, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+    if (region == MAP_FAILED) {
+        return false;
+    }
+    channel.region = static_cast<char*>(region);   // zerado: anéis vazios
+    return true;
+}
+
+// Função para fechar no processo as extremidades do outro lado, para que a
+// morte dele apareça como EOF/EPIPE em vez de uma espera sem fim
+void closePeerEnds(Channel& channel, bool is_parent) {
+    int& rx = is_parent ? channel.child_rx : channel.parent_rx;
+    int& tx = is_parent ? channel.child_tx : channel.parent_tx;
+    if (rx != -1) {
+        close(rx);
+    }
+    if (tx != -1 && tx != rx) {
+        close(tx);
+    }
+    rx = tx = -1;
+}
+
+void closeChannel(Channel& channel) {
+    int fds[4] = { channel.parent_rx, channel.parent_tx, channel.child_rx, channel.child_tx };
+    for (int i = 0; i < 4; i++) {
+        bool duplicate = false;
+        for (int j = 0; j < i; j++) {
+            duplicate = duplicate || fds[j] == fds[i];
+        }
+        if (fds[i] != -1 && !duplicate) {
+            close(fds[i]);
+        }
+    }
+    if (channel.region) {
+        munmap(channel.region, channel.region_size);
+    }
+    channel = Channel();
+}
+
+// Resultado de uma medição
+struct BenchResult {
+    Mechanism mechanism;
+    TestKind test;
+    size_t size;
+    uint64_t iterations;
+    double seconds;
+    Histogram latency;          // apenas ping-pong: ida e volta por iteração
+    
+    BenchResult() : mechanism(MECH_PIPE), test(TEST_PINGPONG), size(0), iterations(0), seconds(0) {}
+};
+
+// Processo filho: ecoa (ping-pong) ou consome (streaming) e confirma o fim
+void runConsumer(Channel& channel, TestKind test, size_t size, uint64_t iterations) {
+    pinToCpu(config.consumer_cpu);
+    std::vector<char> buffer(size);
+    
+    for (uint64_t i = 0; i < iterations; i++) {
+        if (!channelReceive(channel, false, buffer.data(), size)) {
+            _exit(1);
+        }
+        if (test == TEST_PINGPONG && !channelSend(channel, false, buffer.data(), size)) {
+            _exit(1);
+        }
+    }
+    if (test == TEST_STREAM) {
+        char ack = 1;
+        channelSend(channel, false, &ack, 1);
+    }
+    _exit(0);
+}
+
+// Função para executar uma medição (um fork por medição isola os mecanismos)
+bool runMeasurement(Mechanism mechanism, TestKind test, size_t size, BenchResult& result) {
+    uint64_t per_iteration = test == TEST_PINGPONG ? 2 * size : size;
+    uint64_t iterations = config.budget_bytes / per_iteration;
+    iterations = std::max<uint64_t>(MIN_ITERATIONS, std::min<uint64_t>(MAX_ITERATIONS * (test == TEST_STREAM ? 10 : 1), iterations));
+    
+    Channel channel;
+    if (!openChannel(channel, mechanism, size)) {
+        std::cerr << "Erro ao criar canal " << mechanismName(mechanism) << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+    
+    pid_t parent = getpid();
+    pid_t pid = fork();
+    if (pid == -1) {
+        closeChannel(channel);
+        return false;
+    }
+    if (pid == 0) {
+        closePeerEnds(channel, false);
+        channel.peer = parent;
+        runConsumer(channel, test, size, iterations);
+    }
+    closePeerEnds(channel, true);
+    channel.peer = pid;
+    channel.peer_is_child = true;
+    
+    pinToCpu(config.producer_cpu);
+    std::vector<char> buffer(size, 'x');
+    result = BenchResult();
+    result.mechanism = mechanism;
+    result.test = test;
+    result.size = size;
+    result.iterations = iterations;
+    bool ok = true;
+    
+    uint64_t start = monotonicNs();
+    for (uint64_t i = 0; i < iterations && ok; i++) {
+        if (test == TEST_PINGPONG) {
+            uint64_t sent = monotonicNs();
+            ok = channelSend(channel, true, buffer.data(), size) &&
+                 channelReceive(channel, true, buffer.data(), size);
+            histogramRecord(result.latency, monotonicNs() - sent);
+        } else {
+            ok = channelSend(channel, true, buffer.data(), size);
+        }
+    }
+    if (ok && test == TEST_STREAM) {
+        char ack;
+        ok = channelReceive(channel, true, &ack, 1);
+    }
+    result.seconds = (monotonicNs() - start) / 1e9;
+    
+    int status = channel.peer_status;
+    if (!channel.peer_exited) {
+        waitpid(pid, &status, 0);
+    }
+    closeChannel(channel);
+    return ok && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+// Função para emitir um resultado (JSON por linha ou CSV)
+void printResult(const BenchResult& r) {
+    double bytes = (double)r.iterations * r.size * (r.test == TEST_PINGPONG ? 2 : 1);
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(3);
+    
+    if (config.csv) {
+        ss << mechanismName(r.mechanism) << ","
+           << (r.test == TEST_PINGPONG ? "pingpong" : "stream") << ","
+           << r.size << "," << r.iterations << "," << r.seconds << ","
+           << bytes / r.seconds / 1e6 << "," << r.iterations / r.seconds << ",";
+        if (r.test == TEST_PINGPONG) {
+            ss << histogramPercentile(r.latency, 50) / 1e3 << ","
+               << histogramPercentile(r.latency, 99) / 1e3 << ","
+               << histogramPercentile(r.latency, 99.9) / 1e3 << ","
+               << r.latency.max / 1e3;
+        } else {
+            ss << ",,,";
+        }
+    } else {
+        ss << "{\"mechanism\": \"" << mechanismName(r.mechanism) << "\","
+           << "\"test\": \"" << (r.test == TEST_PINGPONG ? "pingpong" : "stream") << "\","
+           << "\"size\": " << r.size << ","
+           << "\"iterations\": " << r.iterations << ","
+           << "\"seconds\": " << r.seconds << ","
+           << "\"mb_per_sec\": " << bytes / r.seconds / 1e6 << ","
+           << "\"msgs_per_sec\": " << r.iterations / r.seconds;
+        if (r.test == TEST_PINGPONG) {
+            ss << ",\"rtt_p50_us\": " << histogramPercentile(r.latency, 50) / 1e3
+               << ",\"rtt_p99_us\": " << histogramPercentile(r.latency, 99) / 1e3
+               << ",\"rtt_p999_us\": " << histogramPercentile(r.latency, 99.9) / 1e3
+               << ",\"rtt_max_us\": " << r.latency.max / 1e3;
+        }
+        ss << "}";
+    }
+    std::cout << ss.str() << std::endl;
+}
+
+// Função para interpretar tamanhos como 8, 4K, 1M
+size_t parseSize(const std::string& text) {
+    char* end = nullptr;
+    unsigned long long value = strtoull(text.c_str(), &end, 10);
+    if (end && (*end == 'K' || *end == 'k')) {
+        value *= 1024;
+    } else if (end && (*end == 'M' || *end == 'm')) {
+        value *= 1024 * 1024;
+    }
+    return (size_t)value;
+}
+
+std::vector<std::string> splitList(const std::string& text) {
+    std::vector<std::string> items;
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+// Função para processar as opções de linha de comando (--opcao=valor)
+bool parseArguments(int argc, char* argv[]) {
+    std::string mechanisms = "pipe,socket,shm";
+    std::string tests = "pingpong,stream";
+    std::string sizes = "8,64,512,4K,32K,256K,1M,4M";
+    
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        size_t eq = arg.find('=');
+        std::string name = arg.substr(0, eq);
+        std::string value = eq == std::string::npos ? "" : arg.substr(eq + 1);
+        
+        if (name == "--mechanisms") {
+            mechanisms = value;
+        } else if (name == "--tests") {
+            tests = value;
+        } else if (name == "--sizes") {
+            sizes = value;
+        } else if (name == "--producer-cpu") {
+            config.producer_cpu = atoi(value.c_str());
+        } else if (name == "--consumer-cpu") {
+            config.consumer_cpu = atoi(value.c_str());
+        } else if (name == "--budget") {
+            config.budget_bytes = parseSize(value);
+        } else if (name == "--format" && (value == "json" || value == "csv")) {
+            config.csv = value == "csv";
+        } else {
+            std::cerr << "Opção não reconhecida: " << arg << std::endl
+                      << "uso: ipc_bench [--mechanisms=pipe,socket,shm] [--tests=pingpong,stream]"
+                      << " [--sizes=8,4K,1M] [--producer-cpu=N] [--consumer-cpu=N]"
+                      << " [--budget=64M] [--format=json|csv]" << std::endl;
+            return false;
+        }
+    }
+    
+    std::vector<std::string> items = splitList(mechanisms);
+    for (size_t i = 0; i < items.size(); i++) {
+        if (items[i] == "pipe") {
+            config.mechanisms.push_back(MECH_PIPE);
+        } else if (items[i] == "socket") {
+            config.mechanisms.push_back(MECH_SOCKET);
+        } else if (items[i] == "shm") {
+            config.mechanisms.push_back(MECH_SHM);
+        } else {
+            std::cerr << "Mecanismo desconhecido: " << items[i] << std::endl;
+            return false;
+        }
+    }
+    
+    items = splitList(tests);
+    for (size_t i = 0; i < items.size(); i++) {
+        if (items[i] == "pingpong") {
+            config.tests.push_back(TEST_PINGPONG);
+        } else if (items[i] == "stream") {
+            config.tests.push_back(TEST_STREAM);
+        } else {
+            std::cerr << "Teste desconhecido: " << items[i] << std::endl;
+            return false;
+        }
+    }
+    
+    items = splitList(sizes);
+    for (size_t i = 0; i < items.size(); i++) {
+        size_t size = parseSize(items[i]);
+        if (size == 0) {
+            std::cerr << "Tamanho inválido: " << items[i] << std::endl;
+            return false;
+        }
+        config.sizes.push_back(size);
+    }
+    
+    return !config.mechanisms.empty() && !config.tests.empty() && !config.sizes.empty() &&
+           config.budget_bytes > 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (!parseArguments(argc, argv)) {
+        return 1;
+    }
+    
+    signal(SIGPIPE, SIG_IGN);
+    
+    // Com uma única CPU a espera ativa só atrasa o outro processo
+    if (sysconf(_SC_NPROCESSORS_ONLN) == 1 ||
+        (config.producer_cpu >= 0 && config.producer_cpu == config.consumer_cpu)) {
+        config.spin_limit = 0;
+    }
+    
+    if (config.csv) {
+        std::cout << "mechanism,test,size,iterations,seconds,mb_per_sec,msgs_per_sec,"
+                  << "rtt_p50_us,rtt_p99_us,rtt_p999_us,rtt_max_us" << std::endl;
+    }
+    
+    int failures = 0;
+    for (size_t t = 0; t < config.tests.size(); t++) {
+        for (size_t m = 0; m < config.mechanisms.size(); m++) {
+            for (size_t s = 0; s < config.sizes.size(); s++) {
+                BenchResult result;
+                if (runMeasurement(config.mechanisms[m], config.tests[t], config.sizes[s], result)) {
+                    printResult(result);
+                } else {
+                    std::cerr << "Falha na medição " << mechanismName(config.mechanisms[m])
+                              << " size=" << config.sizes[s] << std::endl;
+                    failures++;
+                }
+            }
+        }
+    }
+    
+    return failures ? 1 : 0;
+}
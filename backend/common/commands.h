@@ -0,0 +1,157 @@
+#ifndef COMMON_COMMANDS_H
+#define COMMON_COMMANDS_H
+
+// Loop de comandos compartilhado pelos programas interativos do backend.
+//
+// Cada programa fornece um handler para um comando (false encerra o programa)
+// e um reporter para os eventos do próprio loop. O loop lê a entrada padrão
+// sem pausa fixa entre comandos; --throttle-us=<n> reintroduz uma pausa
+// opcional. Dois comandos são tratados aqui para todos os programas:
+//     batch <arquivo>           executa os comandos do arquivo (# comenta)
+//     repeat <n> <comando>      executa o comando n vezes
+// Ambos rodam sem pausa; o batch/repeat mais externo relata o tempo total e
+// as operações por segundo.
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+
+#define COMMAND_MAX_DEPTH 8                 // batch/repeat aninhados
+#define COMMAND_MAX_REPEAT 100000000
+
+typedef std::function<bool(const std::string&)> CommandHandler;
+typedef std::function<void(const std::string& type, const std::string& message,
+                           const std::string& data)> CommandReporter;
+
+// Estrutura para o estado do loop de comandos
+struct CommandRunner {
+    CommandHandler handler;
+    CommandReporter report;
+    useconds_t throttle_us;     // pausa após cada comando do stdin (0: nenhuma)
+    int depth;
+    uint64_t executed;          // comandos simples executados (para ops/s)
+    
+    CommandRunner(CommandHandler handler, CommandReporter report)
+        : handler(handler), report(report), throttle_us(0), depth(0), executed(0) {}
+};
+
+// Função para consumir --throttle-us=<n> de argv, como logInit faz com as
+// opções do logger
+inline void commandInit(int& argc, char* argv[], CommandRunner& runner) {
+    int kept = 1;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.find("--throttle-us=") == 0) {
+            runner.throttle_us = (useconds_t)strtoul(arg.c_str() + 14, nullptr, 10);
+        } else {
+            argv[kept++] = argv[i];
+        }
+    }
+    argc = kept;
+    argv[argc] = nullptr;
+}
+
+inline bool runCommand(CommandRunner& runner, const std::string& command);
+
+// Função para relatar o resultado de um batch/repeat
+inline void reportCommandRun(CommandRunner& runner, const std::string& message, uint64_t start_executed,
+                             std::chrono::steady_clock::time_point start) {
+    double elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    uint64_t commands = runner.executed - start_executed;
+    
+    std::ostringstream data;
+    data.setf(std::ios::fixed);
+    data.precision(1);
+    data << "commands=" << commands << " elapsed_ms=" << elapsed_ms
+         << " ops_per_sec=" << (elapsed_ms > 0 ? commands * 1000.0 / elapsed_ms : 0.0);
+    runner.report("stats", message, data.str());
+}
+
+// Função para executar os comandos de um arquivo
+inline bool runBatch(CommandRunner& runner, const std::string& path) {
+    std::ifstream file(path.c_str());
+    if (!file) {
+        runner.report("error", "Não foi possível abrir o arquivo de comandos", path);
+        return true;
+    }
+    
+    uint64_t start_executed = runner.executed;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    bool keep_running = true;
+    std::string line;
+    while (keep_running && std::getline(file, line)) {
+        size_t first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#') {
+            continue;
+        }
+        size_t last = line.find_last_not_of(" \t\r");
+        keep_running = runCommand(runner, line.substr(first, last - first + 1));
+    }
+    
+    if (runner.depth == 1) {
+        reportCommandRun(runner, "Batch concluído: " + path, start_executed, start);
+    }
+    return keep_running;
+}
+
+// Função para executar um comando n vezes
+inline bool runRepeat(CommandRunner& runner, const std::string& args) {
+    std::istringstream input(args);
+    long count = 0;
+    std::string command;
+    input >> count;
+    std::getline(input >> std::ws, command);
+    if (count <= 0 || count > COMMAND_MAX_REPEAT || command.empty()) {
+        runner.report("error", "Comando repeat requer quantidade e comando", "uso: repeat <n> <comando>");
+        return true;
+    }
+    
+    uint64_t start_executed = runner.executed;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    bool keep_running = true;
+    for (long i = 0; i < count && keep_running; i++) {
+        keep_running = runCommand(runner, command);
+    }
+    
+    if (runner.depth == 1) {
+        reportCommandRun(runner, "Repeat concluído: " + command, start_executed, start);
+    }
+    return keep_running;
+}
+
+// Função para executar um comando; false quando o programa deve encerrar
+inline bool runCommand(CommandRunner& runner, const std::string& command) {
+    bool nested = command.find("batch ") == 0 || command.find("repeat ") == 0;
+    if (!nested) {
+        runner.executed++;
+        return runner.handler(command);
+    }
+    if (runner.depth >= COMMAND_MAX_DEPTH) {
+        runner.report("error", "Aninhamento de batch/repeat excede o limite", command);
+        return true;
+    }
+    
+    runner.depth++;
+    bool keep_running = command[0] == 'b' ? runBatch(runner, command.substr(6)) : runRepeat(runner, command.substr(7));
+    runner.depth--;
+    return keep_running;
+}
+
+// Função para ler e executar comandos do stdin até EOF ou encerramento
+inline void runCommandLoop(CommandRunner& runner) {
+    std::string command;
+    while (std::getline(std::cin, command)) {
+        if (!runCommand(runner, command)) {
+            break;
+        }
+        if (runner.throttle_us > 0) {
+            usleep(runner.throttle_us);
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,105 @@
+#ifndef COMMON_HISTOGRAM_H
+#define COMMON_HISTOGRAM_H
+
+// Histograma de latência no estilo HDR: buckets log-lineares com 64
+// sub-buckets por potência de dois (erro relativo < 1.6%), registro O(1)
+// sem alocação e faixa completa de uint64_t (valores em nanossegundos).
+
+#include <cstdint>
+#include <cstring>
+
+#define HISTOGRAM_SUB_BITS 7                                  // 2^7 valores exatos iniciais
+#define HISTOGRAM_SUB_HALF (1 << (HISTOGRAM_SUB_BITS - 1))    // 64 sub-buckets por faixa
+#define HISTOGRAM_BUCKETS ((64 - HISTOGRAM_SUB_BITS + 1) * HISTOGRAM_SUB_HALF + HISTOGRAM_SUB_HALF)
+
+struct Histogram {
+    uint64_t counts[HISTOGRAM_BUCKETS];
+    uint64_t total;
+    uint64_t min;
+    uint64_t max;
+    double sum;
+    
+    Histogram() : total(0), min(UINT64_MAX), max(0), sum(0) {
+        memset(counts, 0, sizeof(counts));
+    }
+};
+
+// Função para mapear um valor ao índice do bucket
+inline int histogramIndex(uint64_t value) {
+    if (value < (1u << HISTOGRAM_SUB_BITS)) {
+        return (int)value;
+    }
+    int msb = 63 - __builtin_clzll(value);
+    int shift = msb - (HISTOGRAM_SUB_BITS - 1);
+    return shift * HISTOGRAM_SUB_HALF + (int)(value >> shift);
+}
+
+// Função para obter o maior valor representado por um bucket
+inline uint64_t histogramBucketHigh(int index) {
+    if (index < (1 << HISTOGRAM_SUB_BITS)) {
+        return (uint64_t)index;
+    }
+    int shift = index / HISTOGRAM_SUB_HALF - 1;
+    uint64_t sub = (uint64_t)(index - shift * HISTOGRAM_SUB_HALF);
+    return (sub << shift) + ((1ULL << shift) - 1);
+}
+
+inline void histogramReset(Histogram& h) {
+    memset(h.counts, 0, sizeof(h.counts));
+    h.total = 0;
+    h.min = UINT64_MAX;
+    h.max = 0;
+    h.sum = 0;
+}
+
+inline void histogramRecord(Histogram& h, uint64_t value) {
+    h.counts[histogramIndex(value)]++;
+    h.total++;
+    h.sum += (double)value;
+    if (value < h.min) {
+        h.min = value;
+    }
+    if (value > h.max) {
+        h.max = value;
+    }
+}
+
+inline void histogramMerge(Histogram& into, const Histogram& from) {
+    for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        into.counts[i] += from.counts[i];
+    }
+    into.total += from.total;
+    into.sum += from.sum;
+    if (from.min < into.min) {
+        into.min = from.min;
+    }
+    if (from.max > into.max) {
+        into.max = from.max;
+    }
+}
+
+// Função para obter o percentil (0-100); o valor é limitado ao máximo observado
+inline uint64_t histogramPercentile(const Histogram& h, double percentile) {
+    if (h.total == 0) {
+        return 0;
+    }
+    uint64_t target = (uint64_t)(percentile / 100.0 * h.total + 0.5);
+    if (target < 1) {
+        target = 1;
+    }
+    uint64_t seen = 0;
+    for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        seen += h.counts[i];
+        if (seen >= target) {
+            uint64_t high = histogramBucketHigh(i);
+            return high < h.max ? high : h.max;
+        }
+    }
+    return h.max;
+}
+
+inline double histogramMean(const Histogram& h) {
+    return h.total ? h.sum / h.total : 0;
+}
+
+#endif
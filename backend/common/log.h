@@ -0,0 +1,1286 @@
+#ifndef COMMON_LOG_H
+#define COMMON_LOG_H
+
+// Logger compartilhado pelos programas do backend: linhas JSON por padrão ou
+// registros binários com --format=binary (ver tools/log_decode).
+//
+// Cada thread formata o evento em um buffer próprio reutilizado (sem alocação
+// e sem lock durante a formatação). Com logInit o evento pronto vai para uma
+// fila consumida por uma thread emissora que escreve em lotes; sem ela (ou
+// com --log-sync), cada evento sai com um único write() na saída padrão.
+// O timestamp em texto é recalculado uma vez por segundo; a fração
+// de segundo vem do relógio monotônico relativo ao início do segundo em cache.
+//
+// Uso:
+//     logInit(argc, argv);                // no início de main
+//     LogLine& line = logBegin("send");
+//     logString(line, "component", "server");
+//     logInt(line, "client_id", 3);
+//     logString(line, "message", "Resposta enviada");
+//     logEnd(line);
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <cerrno>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <sstream>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <cstdlib>
+#include <unistd.h>
+#include <sched.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#define LOG_LINE_CAPACITY 65536             // maior evento; campos maiores são truncados
+#define LOG_LINE_RESERVE 32                 // espaço final para a marca de truncamento e "}\n"
+#define LOG_TRUNCATED_MARK "...[truncado]"
+
+// Buffer de formatação de uma thread
+struct LogLine {
+    char buffer[LOG_LINE_CAPACITY];
+    size_t length;
+    bool truncated;
+};
+
+// Segundo de calendário em cache e o instante monotônico em que ele começou
+struct LogClock {
+    int64_t second_start_ns;
+    char text[32];
+    size_t text_length;
+};
+
+inline LogLine& logThreadLine() {
+    static thread_local LogLine line;
+    return line;
+}
+
+inline LogClock& logThreadClock() {
+    static thread_local LogClock clock = { 0, { 0 }, 0 };
+    return clock;
+}
+
+// Serializa apenas o write(): linhas maiores que PIPE_BUF não são atômicas
+inline std::mutex& logWriteMutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+inline int64_t logMonotonicNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// Função para emitir uma linha pronta com um único write()
+inline void logWriteLine(const char* data, size_t length) {
+    std::lock_guard<std::mutex> guard(logWriteMutex());
+    while (length > 0) {
+        ssize_t n = write(STDOUT_FILENO, data, length);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return;
+        }
+        data += n;
+        length -= n;
+    }
+}
+
+// Escrita sem verificação, apenas dentro de LOG_LINE_RESERVE
+inline void logAppendRaw(LogLine& line, const char* data, size_t length) {
+    memcpy(line.buffer + line.length, data, length);
+    line.length += length;
+}
+
+// Sequências curtas (escapes) nunca são cortadas ao meio
+inline void logAppend(LogLine& line, const char* data, size_t length) {
+    size_t room = LOG_LINE_CAPACITY - LOG_LINE_RESERVE - line.length;
+    if (length > room) {
+        line.truncated = true;
+        length = length <= 8 ? 0 : room;
+    }
+    memcpy(line.buffer + line.length, data, length);
+    line.length += length;
+}
+
+inline void logAppendChar(LogLine& line, char c) {
+    if (line.length < LOG_LINE_CAPACITY - LOG_LINE_RESERVE) {
+        line.buffer[line.length++] = c;
+    } else {
+        line.truncated = true;
+    }
+}
+
+inline void logAppendUnsigned(LogLine& line, uint64_t value, int min_digits = 1) {
+    char digits[24];
+    int count = 0;
+    do {
+        digits[count++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value > 0 || count < min_digits);
+    while (count > 0) {
+        logAppendChar(line, digits[--count]);
+    }
+}
+
+// Função para escrever o timestamp "AAAA-MM-DD HH:MM:SS.uuuuuu"
+inline void logAppendTimestamp(LogLine& line) {
+    LogClock& clock = logThreadClock();
+    int64_t now = logMonotonicNs();
+    int64_t offset = now - clock.second_start_ns;
+    
+    if (clock.text_length == 0 || offset < 0 || offset >= 1000000000LL) {
+        struct timespec real;
+        clock_gettime(CLOCK_REALTIME, &real);
+        now = logMonotonicNs();
+        clock.second_start_ns = now - real.tv_nsec;
+        offset = real.tv_nsec;
+        
+        struct tm tm;
+        time_t seconds = real.tv_sec;
+        localtime_r(&seconds, &tm);
+        clock.text_length = strftime(clock.text, sizeof(clock.text), "%Y-%m-%d %H:%M:%S", &tm);
+    }
+    
+    logAppend(line, clock.text, clock.text_length);
+    logAppendChar(line, '.');
+    logAppendUnsigned(line, (uint64_t)offset / 1000, 6);
+}
+
+// Função para escrever uma string JSON escapada
+inline void logAppendEscaped(LogLine& line, const char* value, size_t length) {
+    static const char hex[] = "0123456789abcdef";
+    for (size_t i = 0; i < length && !line.truncated; i++) {
+        unsigned char c = (unsigned char)value[i];
+        switch (c) {
+            case '"':  logAppend(line, "\\\"", 2); break;
+            case '\\': logAppend(line, "\\\\", 2); break;
+            case '\b': logAppend(line, "\\b", 2);  break;
+            case '\f': logAppend(line, "\\f", 2);  break;
+            case '\n': logAppend(line, "\\n", 2);  break;
+            case '\r': logAppend(line, "\\r", 2);  break;
+            case '\t': logAppend(line, "\\t", 2);  break;
+            default:
+                if (c < 0x20) {
+                    char escaped[6] = { '\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xf] };
+                    logAppend(line, escaped, sizeof(escaped));
+                } else {
+                    logAppendChar(line, (char)c);
+                }
+        }
+    }
+}
+
+inline void logAppendKey(LogLine& line, const char* key) {
+    logAppend(line, ",\"", 2);
+    logAppend(line, key, strlen(key));
+    logAppend(line, "\":", 2);
+}
+
+// ---------------------------------------------------------------------------
+// Formato binário (--format=binary): registros de layout fixo em vez de JSON.
+// Tipos, chaves e mensagens são trocados por ids; cada string ganha um id na
+// primeira vez que aparece e sua definição (LOG_RECORD_STRING) é escrita de
+// forma síncrona antes de qualquer evento que a use. O decodificador
+// (tools/log_decode) reconstrói as mesmas linhas JSON do modo padrão.
+//
+// Fluxo: LogStreamHeader e então registros LogRecordHeader + payload. O
+// payload de um evento é uma sequência de campos:
+//     uint32 key_id [uint32 tamanho + bytes se key_id == 0]
+//     uint8 kind
+//     STRING: uint32 tamanho + bytes | INT: int64 | MESSAGE: nada
+//     (o texto é o message_id do cabeçalho) | JSON_FIELDS: uint32 tamanho +
+//     campos JSON já formatados
+// Com type_id == 0 o tipo vem antes dos campos como uint32 tamanho + bytes.
+// Inteiros na ordem de bytes do host.
+// ---------------------------------------------------------------------------
+
+#define LOG_STREAM_MAGIC "IPCL"
+#define LOG_STREAM_VERSION 1
+#define LOG_STRING_TABLE_MAX 4096           // ids por processo
+#define LOG_MESSAGE_TABLE_LIMIT 3072        // acima disso só tipos e chaves ganham id
+#define LOG_MESSAGE_INTERN_MAX 256          // mensagens maiores vão sempre inline
+#define LOG_STRING_CACHE_MAX 8192           // entradas do cache por thread
+
+enum LogFormat {
+    LOG_FORMAT_JSON,
+    LOG_FORMAT_BINARY
+};
+
+enum LogRecordKind {
+    LOG_RECORD_EVENT = 1,
+    LOG_RECORD_STRING = 2       // define message_id -> payload
+};
+
+enum LogRecordFlags {
+    LOG_RECORD_TRUNCATED = 1
+};
+
+enum LogValueKind {
+    LOG_VALUE_STRING = 1,
+    LOG_VALUE_INT = 2,
+    LOG_VALUE_MESSAGE = 3,
+    LOG_VALUE_JSON_FIELDS = 4
+};
+
+struct LogStreamHeader {
+    char magic[4];
+    uint16_t version;
+    uint16_t record_header_size;
+};
+
+struct LogRecordHeader {
+    uint16_t kind;
+    uint16_t flags;
+    uint32_t length;            // bytes de payload após o cabeçalho
+    uint64_t timestamp_ns;      // CLOCK_REALTIME
+    int32_t pid;
+    uint32_t type_id;
+    uint32_t message_id;        // 0: sem mensagem ou mensagem inline
+    uint32_t reserved;
+};
+
+static_assert(sizeof(LogStreamHeader) == 8, "LogStreamHeader deve ter 8 bytes");
+static_assert(sizeof(LogRecordHeader) == 32, "LogRecordHeader deve ter 32 bytes");
+
+inline LogFormat& logFormat() {
+    static LogFormat format = LOG_FORMAT_JSON;
+    return format;
+}
+
+// pid em cache (atualizado no filho após fork): evita um getpid() por evento
+inline pid_t& logPid() {
+    static pid_t pid = getpid();
+    return pid;
+}
+
+// Tabela global de strings; só cresce. Apenas o processo que a criou define
+// novos ids: filhos de fork reutilizam os ids herdados (já escritos pelo pai)
+// e escrevem strings novas inline, sem risco de ids conflitantes no fluxo.
+struct LogStringTable {
+    std::mutex mutex;
+    std::unordered_map<std::string, uint32_t> ids;
+    const std::string* strings[LOG_STRING_TABLE_MAX];
+    uint32_t next_id;
+    pid_t owner;
+    
+    LogStringTable() : next_id(1), owner(getpid()) {
+        memset(strings, 0, sizeof(strings));
+    }
+};
+
+inline LogStringTable& logStringTable() {
+    static LogStringTable* table = new LogStringTable();
+    return *table;
+}
+
+// Cache por thread hash -> id: o caminho comum não toma o mutex da tabela
+inline std::unordered_map<uint64_t, uint32_t>& logStringCache() {
+    static thread_local std::unordered_map<uint64_t, uint32_t> cache;
+    return cache;
+}
+
+inline uint64_t logHash(const char* value, size_t length) {
+    uint64_t hash = 1469598103934665603ULL;     // FNV-1a
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ (unsigned char)value[i]) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+// Função para escrever a definição de um id no fluxo
+inline void logWriteStringRecord(uint32_t id, const std::string& value) {
+    LogRecordHeader header;
+    memset(&header, 0, sizeof(header));
+    header.kind = LOG_RECORD_STRING;
+    header.length = (uint32_t)value.size();
+    header.pid = logPid();
+    header.message_id = id;
+    
+    std::string record(reinterpret_cast<const char*>(&header), sizeof(header));
+    record += value;
+    logWriteLine(record.data(), record.size());
+}
+
+// Função para obter o id de uma string; 0 quando ela deve ir inline
+inline uint32_t logIntern(const char* value, size_t length, bool is_message) {
+    if (is_message && length > LOG_MESSAGE_INTERN_MAX) {
+        return 0;
+    }
+    LogStringTable& table = logStringTable();
+    std::unordered_map<uint64_t, uint32_t>& cache = logStringCache();
+    uint64_t hash = logHash(value, length);
+    
+    std::unordered_map<uint64_t, uint32_t>::iterator cached = cache.find(hash);
+    if (cached != cache.end()) {
+        uint32_t id = cached->second;
+        if (id == 0) {
+            return 0;
+        }
+        const std::string* text = table.strings[id];
+        if (text->size() == length && memcmp(text->data(), value, length) == 0) {
+            return id;
+        }
+    }
+    
+    uint32_t id = 0;
+    {
+        std::lock_guard<std::mutex> guard(table.mutex);
+        std::string key(value, length);
+        std::unordered_map<std::string, uint32_t>::iterator found = table.ids.find(key);
+        if (found != table.ids.end()) {
+            id = found->second;
+        } else if (table.owner == logPid() &&
+                   table.next_id < (is_message ? LOG_MESSAGE_TABLE_LIMIT : LOG_STRING_TABLE_MAX)) {
+            id = table.next_id++;
+            table.strings[id] = new std::string(key);
+            table.ids[key] = id;
+            // Escrita síncrona sob o mutex: a definição precede qualquer uso do id
+            logWriteStringRecord(id, key);
+        }
+    }
+    
+    if (cached == cache.end()) {
+        if (cache.size() >= LOG_STRING_CACHE_MAX) {
+            cache.clear();
+        }
+        cache[hash] = id;
+    }
+    return id;
+}
+
+inline bool logFits(LogLine& line, size_t length) {
+    return length <= LOG_LINE_CAPACITY - LOG_LINE_RESERVE - line.length;
+}
+
+inline void logBinaryPut(LogLine& line, const void* data, size_t length) {
+    memcpy(line.buffer + line.length, data, length);
+    line.length += length;
+}
+
+inline void logBinaryPutString(LogLine& line, const char* value, size_t length) {
+    uint32_t size = (uint32_t)length;
+    logBinaryPut(line, &size, sizeof(size));
+    logBinaryPut(line, value, length);
+}
+
+inline LogRecordHeader* logBinaryHeader(LogLine& line) {
+    return reinterpret_cast<LogRecordHeader*>(line.buffer);
+}
+
+inline void logBinaryBegin(LogLine& line, const char* type) {
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    size_t type_length = strlen(type);
+    
+    LogRecordHeader header;
+    header.kind = LOG_RECORD_EVENT;
+    header.flags = 0;
+    header.length = 0;
+    header.timestamp_ns = (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+    header.pid = logPid();
+    header.type_id = logIntern(type, type_length, false);
+    header.message_id = 0;
+    header.reserved = 0;
+    logBinaryPut(line, &header, sizeof(header));
+    if (header.type_id == 0) {
+        logBinaryPutString(line, type, type_length);
+    }
+}
+
+// Função para iniciar um campo; false (e truncated) quando não cabe
+inline bool logBinaryField(LogLine& line, const char* key, LogValueKind kind, size_t value_size) {
+    if (line.truncated) {
+        return false;
+    }
+    size_t key_length = strlen(key);
+    uint32_t key_id = logIntern(key, key_length, false);
+    size_t needed = sizeof(uint32_t) + (key_id ? 0 : sizeof(uint32_t) + key_length) + 1 + value_size;
+    if (!logFits(line, needed)) {
+        line.truncated = true;
+        return false;
+    }
+    logBinaryPut(line, &key_id, sizeof(key_id));
+    if (key_id == 0) {
+        logBinaryPutString(line, key, key_length);
+    }
+    uint8_t kind_byte = (uint8_t)kind;
+    logBinaryPut(line, &kind_byte, 1);
+    return true;
+}
+
+inline void logBinaryString(LogLine& line, const char* key, const char* value, size_t length) {
+    LogRecordHeader* header = logBinaryHeader(line);
+    if (header->message_id == 0 && strcmp(key, "message") == 0) {
+        uint32_t id = logIntern(value, length, true);
+        if (id != 0) {
+            if (logBinaryField(line, key, LOG_VALUE_MESSAGE, 0)) {
+                header->message_id = id;
+            }
+            return;
+        }
+    }
+    
+    // Strings longas são cortadas para caber, como no modo JSON
+    if (!logBinaryField(line, key, LOG_VALUE_STRING, sizeof(uint32_t))) {
+        return;
+    }
+    size_t room = LOG_LINE_CAPACITY - LOG_LINE_RESERVE - line.length - sizeof(uint32_t);
+    if (length > room) {
+        length = room;
+        line.truncated = true;
+    }
+    logBinaryPutString(line, value, length);
+}
+
+inline void logBinaryInt(LogLine& line, const char* key, int64_t value) {
+    if (logBinaryField(line, key, LOG_VALUE_INT, sizeof(value))) {
+        logBinaryPut(line, &value, sizeof(value));
+    }
+}
+
+inline void logBinaryFields(LogLine& line, const char* fields, size_t length) {
+    if (logBinaryField(line, "fields", LOG_VALUE_JSON_FIELDS, sizeof(uint32_t) + length)) {
+        logBinaryPutString(line, fields, length);
+    }
+}
+
+// Função para completar o cabeçalho com o tamanho do payload
+inline void logBinaryFinish(LogLine& line) {
+    LogRecordHeader* header = logBinaryHeader(line);
+    header->length = (uint32_t)(line.length - sizeof(LogRecordHeader));
+    if (line.truncated) {
+        header->flags |= LOG_RECORD_TRUNCATED;
+    }
+}
+
+// Função para fechar o evento no formato atual (tamanho do registro ou fim do JSON)
+inline void logFinish(LogLine& line) {
+    if (logFormat() == LOG_FORMAT_BINARY) {
+        logBinaryFinish(line);
+    } else {
+        logAppendRaw(line, "}\n", 2);
+    }
+}
+
+// Função para escrever o cabeçalho do fluxo binário
+inline void logWriteStreamHeader() {
+    LogStreamHeader header;
+    memcpy(header.magic, LOG_STREAM_MAGIC, sizeof(header.magic));
+    header.version = LOG_STREAM_VERSION;
+    header.record_header_size = sizeof(LogRecordHeader);
+    logWriteLine(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+// Função para iniciar um evento com timestamp e tipo
+inline LogLine& logBegin(const char* type) {
+    LogLine& line = logThreadLine();
+    line.length = 0;
+    line.truncated = false;
+    if (logFormat() == LOG_FORMAT_BINARY) {
+        logBinaryBegin(line, type);
+        return line;
+    }
+    logAppend(line, "{\"timestamp\":\"", 14);
+    logAppendTimestamp(line);
+    logAppend(line, "\",\"type\":\"", 10);
+    logAppendEscaped(line, type, strlen(type));
+    logAppendChar(line, '"');
+    return line;
+}
+
+inline LogLine& logBegin(const std::string& type) {
+    return logBegin(type.c_str());
+}
+
+// Campos após um truncamento são descartados para manter o JSON válido
+inline void logString(LogLine& line, const char* key, const char* value, size_t length) {
+    if (line.truncated) {
+        return;
+    }
+    if (logFormat() == LOG_FORMAT_BINARY) {
+        logBinaryString(line, key, value, length);
+        return;
+    }
+    size_t field_start = line.length;
+    logAppendKey(line, key);
+    logAppendChar(line, '"');
+    if (line.truncated) {
+        line.length = field_start;      // sem espaço nem para a chave
+        return;
+    }
+    logAppendEscaped(line, value, length);
+    if (line.truncated) {
+        logAppendRaw(line, LOG_TRUNCATED_MARK, sizeof(LOG_TRUNCATED_MARK) - 1);
+    }
+    logAppendRaw(line, "\"", 1);
+}
+
+inline void logString(LogLine& line, const char* key, const char* value) {
+    logString(line, key, value, strlen(value));
+}
+
+inline void logString(LogLine& line, const char* key, const std::string& value) {
+    logString(line, key, value.data(), value.size());
+}
+
+inline void logInt(LogLine& line, const char* key, int64_t value) {
+    if (line.truncated) {
+        return;
+    }
+    if (logFormat() == LOG_FORMAT_BINARY) {
+        logBinaryInt(line, key, value);
+        return;
+    }
+    size_t field_start = line.length;
+    logAppendKey(line, key);
+    if (value < 0) {
+        logAppendChar(line, '-');
+        logAppendUnsigned(line, (uint64_t)(-(value + 1)) + 1);
+    } else {
+        logAppendUnsigned(line, (uint64_t)value);
+    }
+    if (line.truncated) {
+        line.length = field_start;
+    }
+}
+
+// Função para acrescentar campos JSON já formatados ("a":1,"b":{...}) de
+// eventos compostos; descartados por inteiro se não couberem
+inline void logFields(LogLine& line, const std::string& fields) {
+    if (line.truncated) {
+        return;
+    }
+    if (logFormat() == LOG_FORMAT_BINARY) {
+        logBinaryFields(line, fields.data(), fields.size());
+        return;
+    }
+    if (!logFits(line, fields.size() + 1)) {
+        line.truncated = true;
+        return;
+    }
+    logAppendRaw(line, ",", 1);
+    logAppendRaw(line, fields.data(), fields.size());
+}
+
+// ---------------------------------------------------------------------------
+// Emissor assíncrono: logEnd apenas enfileira o evento em uma fila limitada
+// sem lock (Vyukov MPMC) e uma thread dedicada agrupa os eventos em writev.
+// A política decide o que acontece com a fila cheia: por padrão (block) quem
+// registra espera e nenhum evento se perde; drop_oldest e sample trocam
+// eventos por latência e só valem quando pedidas com --log-policy.
+// ---------------------------------------------------------------------------
+
+#define LOG_QUEUE_SLOTS 2048                // potência de dois
+#define LOG_SLOT_INLINE 480                 // eventos maiores vão para o heap
+#define LOG_BATCH_EVENTS 256                // eventos por writev
+#define LOG_SAMPLE_RATE 8                   // política sample: 1 em N acima do limite
+#define LOG_IDLE_WAIT_MS 100
+#define LOG_DROP_REPORT_NS 1000000000LL     // intervalo mínimo entre relatórios de descarte
+
+static_assert((LOG_QUEUE_SLOTS & (LOG_QUEUE_SLOTS - 1)) == 0, "LOG_QUEUE_SLOTS deve ser potência de dois");
+
+enum LogPolicy {
+    LOG_POLICY_BLOCK,           // espera por espaço (nenhum evento se perde)
+    LOG_POLICY_DROP_OLDEST,     // descarta o evento mais antigo da fila
+    LOG_POLICY_SAMPLE           // acima de 3/4 da fila aceita 1 em LOG_SAMPLE_RATE
+};
+
+struct LogSlot {
+    std::atomic<size_t> sequence;
+    uint32_t length;
+    char* heap;                 // cópia do evento quando length > LOG_SLOT_INLINE
+    char data[LOG_SLOT_INLINE];
+};
+
+struct LogEmitter {
+    LogSlot slots[LOG_QUEUE_SLOTS];
+    char pad0[64];
+    std::atomic<size_t> enqueue_pos;
+    char pad1[64];
+    std::atomic<size_t> dequeue_pos;
+    char pad2[64];
+    std::atomic<size_t> completed;      // eventos escritos ou descartados após enfileirados
+    std::atomic<uint32_t> wake_seq;     // palavra de futex da thread emissora
+    std::atomic<bool> sleeping;
+    std::atomic<bool> running;          // modo assíncrono ativo
+    std::atomic<bool> stopping;
+    std::atomic<uint64_t> dropped;
+    std::atomic<uint64_t> sample_counter;
+    LogPolicy policy;
+    std::thread thread;
+    char batch[LOG_BATCH_EVENTS * LOG_SLOT_INLINE];
+    
+    LogEmitter() : enqueue_pos(0), dequeue_pos(0), completed(0), wake_seq(0), sleeping(false),
+                   running(false), stopping(false), dropped(0), sample_counter(0),
+                   policy(LOG_POLICY_BLOCK) {
+        for (size_t i = 0; i < LOG_QUEUE_SLOTS; i++) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+            slots[i].length = 0;
+            slots[i].heap = nullptr;
+        }
+    }
+};
+
+// Nunca destruído: a thread emissora pode existir até o fim do processo
+inline LogEmitter& logEmitter() {
+    static LogEmitter* emitter = new LogEmitter();
+    return *emitter;
+}
+
+inline const char* logPolicyName(LogPolicy policy) {
+    switch (policy) {
+        case LOG_POLICY_DROP_OLDEST: return "drop_oldest";
+        case LOG_POLICY_SAMPLE: return "sample";
+        default: return "block";
+    }
+}
+
+inline bool logTryEnqueue(LogEmitter& e, const char* data, size_t length) {
+    size_t pos = e.enqueue_pos.load(std::memory_order_relaxed);
+    while (true) {
+        LogSlot& slot = e.slots[pos & (LOG_QUEUE_SLOTS - 1)];
+        size_t seq = slot.sequence.load(std::memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+        if (diff == 0) {
+            if (e.enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                slot.length = (uint32_t)length;
+                if (length <= LOG_SLOT_INLINE) {
+                    memcpy(slot.data, data, length);
+                    slot.heap = nullptr;
+                } else {
+                    slot.heap = static_cast<char*>(malloc(length));
+                    if (slot.heap) {
+                        memcpy(slot.heap, data, length);
+                    } else {
+                        slot.length = 0;
+                    }
+                }
+                slot.sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            return false;       // fila cheia
+        } else {
+            pos = e.enqueue_pos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+// Retira o evento mais antigo; a thread emissora o copia para o lote e
+// produtores com drop_oldest o descartam (data == nullptr)
+inline bool logTryDequeue(LogEmitter& e, char* data, size_t& length, char*& heap) {
+    size_t pos = e.dequeue_pos.load(std::memory_order_relaxed);
+    while (true) {
+        LogSlot& slot = e.slots[pos & (LOG_QUEUE_SLOTS - 1)];
+        size_t seq = slot.sequence.load(std::memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+        if (diff == 0) {
+            if (e.dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                length = slot.length;
+                heap = slot.heap;
+                if (!heap && data) {
+                    memcpy(data, slot.data, length);
+                }
+                slot.sequence.store(pos + LOG_QUEUE_SLOTS, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            return false;       // fila vazia
+        } else {
+            pos = e.dequeue_pos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+inline void logWakeEmitter(LogEmitter& e) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (e.sleeping.load(std::memory_order_relaxed)) {
+        e.wake_seq.fetch_add(1, std::memory_order_release);
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&e.wake_seq), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+    }
+}
+
+// Função para enfileirar um evento pronto aplicando a política de fila cheia
+inline void logEnqueue(LogEmitter& e, const char* data, size_t length) {
+    if (e.policy == LOG_POLICY_SAMPLE) {
+        size_t used = e.enqueue_pos.load(std::memory_order_relaxed) - e.dequeue_pos.load(std::memory_order_relaxed);
+        if (used > LOG_QUEUE_SLOTS * 3 / 4 &&
+            e.sample_counter.fetch_add(1, std::memory_order_relaxed) % LOG_SAMPLE_RATE != 0) {
+            e.dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+    
+    while (!logTryEnqueue(e, data, length)) {
+        if (e.policy == LOG_POLICY_BLOCK) {
+            logWakeEmitter(e);
+            sched_yield();
+        } else if (e.policy == LOG_POLICY_DROP_OLDEST) {
+            size_t old_length;
+            char* heap;
+            if (logTryDequeue(e, nullptr, old_length, heap)) {
+                free(heap);
+                e.dropped.fetch_add(1, std::memory_order_relaxed);
+                e.completed.fetch_add(1, std::memory_order_release);
+            }
+        } else {
+            e.dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+    logWakeEmitter(e);
+}
+
+// Função para escrever um lote de iovecs por completo
+inline void logWritev(struct iovec* iov, int count) {
+    std::lock_guard<std::mutex> guard(logWriteMutex());
+    while (count > 0) {
+        ssize_t n = writev(STDOUT_FILENO, iov, count);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return;
+        }
+        while (count > 0 && (size_t)n >= iov->iov_len) {
+            n -= iov->iov_len;
+            iov++;
+            count--;
+        }
+        if (count > 0) {
+            iov->iov_base = static_cast<char*>(iov->iov_base) + n;
+            iov->iov_len -= n;
+        }
+    }
+}
+
+// Função para relatar descartes como um evento próprio
+inline void logReportDrops(LogEmitter& e, uint64_t& reported, int64_t& last_report_ns, bool force) {
+    uint64_t dropped = e.dropped.load(std::memory_order_relaxed);
+    int64_t now = logMonotonicNs();
+    if (dropped == reported || (!force && now - last_report_ns < LOG_DROP_REPORT_NS)) {
+        return;
+    }
+    
+    LogLine& line = logBegin("log_drops");
+    logString(line, "component", "logger");
+    logString(line, "message", "Eventos de log descartados: fila cheia");
+    logString(line, "policy", logPolicyName(e.policy));
+    logInt(line, "dropped", (int64_t)(dropped - reported));
+    logInt(line, "dropped_total", (int64_t)dropped);
+    logFinish(line);
+    logWriteLine(line.buffer, line.length);
+    reported = dropped;
+    last_report_ns = now;
+}
+
+// Thread emissora: drena a fila em lotes e dorme em futex quando vazia
+inline void logEmitterLoop() {
+    LogEmitter& e = logEmitter();
+    struct iovec iov[2 * LOG_BATCH_EVENTS + 1];
+    char* heaps[LOG_BATCH_EVENTS];
+    uint64_t reported = 0;
+    int64_t last_report_ns = 0;
+    
+    while (true) {
+        int iov_count = 0;
+        int heap_count = 0;
+        size_t batch_length = 0;
+        size_t run_start = 0;
+        int events = 0;
+        
+        while (events < LOG_BATCH_EVENTS) {
+            size_t length;
+            char* heap;
+            if (!logTryDequeue(e, e.batch + batch_length, length, heap)) {
+                break;
+            }
+            events++;
+            if (!heap) {
+                batch_length += length;
+                continue;
+            }
+            // Evento grande: fecha o trecho contíguo do lote e aponta para o heap
+            if (batch_length > run_start) {
+                iov[iov_count].iov_base = e.batch + run_start;
+                iov[iov_count++].iov_len = batch_length - run_start;
+                run_start = batch_length;
+            }
+            iov[iov_count].iov_base = heap;
+            iov[iov_count++].iov_len = length;
+            heaps[heap_count++] = heap;
+        }
+        if (batch_length > run_start) {
+            iov[iov_count].iov_base = e.batch + run_start;
+            iov[iov_count++].iov_len = batch_length - run_start;
+        }
+        
+        if (events > 0) {
+            logWritev(iov, iov_count);
+            for (int i = 0; i < heap_count; i++) {
+                free(heaps[i]);
+            }
+            e.completed.fetch_add(events, std::memory_order_release);
+            logReportDrops(e, reported, last_report_ns, false);
+            continue;
+        }
+        
+        logReportDrops(e, reported, last_report_ns, true);
+        if (e.stopping.load(std::memory_order_acquire)) {
+            return;
+        }
+        
+        // Fila vazia: anuncia que vai dormir e confere de novo antes do futex
+        uint32_t seen = e.wake_seq.load(std::memory_order_acquire);
+        e.sleeping.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (e.enqueue_pos.load(std::memory_order_relaxed) == e.dequeue_pos.load(std::memory_order_relaxed) &&
+            !e.stopping.load(std::memory_order_acquire)) {
+            struct timespec timeout = { 0, LOG_IDLE_WAIT_MS * 1000000L };
+            syscall(SYS_futex, reinterpret_cast<uint32_t*>(&e.wake_seq), FUTEX_WAIT_PRIVATE, seen,
+                    &timeout, nullptr, 0);
+        }
+        e.sleeping.store(false, std::memory_order_relaxed);
+    }
+}
+
+// Função para aguardar que todos os eventos já enfileirados sejam escritos
+inline void logFlush() {
+    LogEmitter& e = logEmitter();
+    if (!e.running.load(std::memory_order_acquire)) {
+        return;
+    }
+    size_t target = e.enqueue_pos.load(std::memory_order_acquire);
+    while (e.completed.load(std::memory_order_acquire) < target) {
+        logWakeEmitter(e);
+        sched_yield();
+    }
+}
+
+// Função para encerrar a thread emissora (registrada com atexit)
+inline void logShutdown() {
+    LogEmitter& e = logEmitter();
+    if (!e.running.load(std::memory_order_acquire)) {
+        return;
+    }
+    logFlush();
+    e.stopping.store(true, std::memory_order_release);
+    e.sleeping.store(true, std::memory_order_relaxed);
+    logWakeEmitter(e);
+    e.thread.join();
+    e.running.store(false, std::memory_order_release);
+}
+
+// fork: o pai esvazia a fila e segura o mutex de escrita durante o fork; o
+// filho não herda a thread emissora e passa a escrever de forma síncrona
+inline void logForkPrepare() {
+    logFlush();
+    logStringTable().mutex.lock();
+    logWriteMutex().lock();
+}
+
+inline void logForkParent() {
+    logWriteMutex().unlock();
+    logStringTable().mutex.unlock();
+}
+
+inline void logForkChild() {
+    logWriteMutex().unlock();
+    logStringTable().mutex.unlock();
+    logPid() = getpid();
+    LogEmitter& e = logEmitter();
+    if (!e.running.load(std::memory_order_relaxed)) {
+        return;
+    }
+    // Eventos ainda na fila pertencem ao pai, que os escreverá
+    for (size_t i = 0; i < LOG_QUEUE_SLOTS; i++) {
+        e.slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    e.enqueue_pos.store(0, std::memory_order_relaxed);
+    e.dequeue_pos.store(0, std::memory_order_relaxed);
+    e.completed.store(0, std::memory_order_relaxed);
+    e.dropped.store(0, std::memory_order_relaxed);
+    e.running.store(false, std::memory_order_release);
+}
+
+// Função para iniciar o emissor assíncrono com a política dada
+inline void logStartAsync(LogPolicy policy) {
+    LogEmitter& e = logEmitter();
+    if (e.running.load(std::memory_order_acquire)) {
+        return;
+    }
+    e.policy = policy;
+    e.stopping.store(false, std::memory_order_relaxed);
+    e.thread = std::thread(logEmitterLoop);
+    e.running.store(true, std::memory_order_release);
+}
+
+// Função para emitir uma linha pronta: enfileira no modo assíncrono ou
+// escreve diretamente
+inline void logEmit(const char* data, size_t length) {
+    LogEmitter& e = logEmitter();
+    if (e.running.load(std::memory_order_acquire)) {
+        logEnqueue(e, data, length);
+    } else {
+        logWriteLine(data, length);
+    }
+}
+
+// Função para fechar o evento e emiti-lo
+inline void logEnd(LogLine& line) {
+    logFinish(line);
+    logEmit(line.buffer, line.length);
+}
+
+// Função para escapar uma string JSON em eventos compostos
+inline std::string logEscape(const std::string& value) {
+    std::string result;
+    result.reserve(value.size());
+    for (size_t i = 0; i < value.size(); i++) {
+        unsigned char c = (unsigned char)value[i];
+        switch (c) {
+            case '"':  result += "\\\""; break;
+            case '\\': result += "\\\\"; break;
+            case '\b': result += "\\b";  break;
+            case '\f': result += "\\f";  break;
+            case '\n': result += "\\n";  break;
+            case '\r': result += "\\r";  break;
+            case '\t': result += "\\t";  break;
+            default:
+                if (c < 0x20) {
+                    static const char hex[] = "0123456789abcdef";
+                    result += "\\u00";
+                    result += hex[c >> 4];
+                    result += hex[c & 0xf];
+                } else {
+                    result += (char)c;
+                }
+        }
+    }
+    return result;
+}
+
+// ---------------------------------------------------------------------------
+// Níveis por categoria e amostragem. A categoria é o tipo do evento ("send",
+// "semaphore", ...); cada uma tem um nível máximo e uma taxa 1-em-N. Os
+// wrappers logEvent dos programas chamam logAccept; em caminhos quentes,
+// LOG_EVENT / LOG_IF testam a categoria antes de avaliar os argumentos, de
+// modo que um evento suprimido não monta nenhuma string.
+//
+//     LOG_EVENT(LOG_DEBUG, "semaphore", "Semáforo obtido", "writer", getpid());
+//     LOG_IF(LOG_DEBUG, "memory_state", displayMemoryState(...));
+//
+// Comando em tempo de execução (ver logLevelCommand):
+//     loglevel                           estado de todas as categorias
+//     loglevel <nível>                   todas as categorias
+//     loglevel <categoria|all> <nível>   off, error, warn, info ou debug
+//     loglevel <categoria|all> sample <n>
+// ---------------------------------------------------------------------------
+
+#define LOG_MAX_CATEGORIES 64
+#define LOG_CATEGORY_NAME 32
+
+enum LogLevel {
+    LOG_OFF = -1,
+    LOG_ERROR = 0,
+    LOG_WARN = 1,
+    LOG_INFO = 2,
+    LOG_DEBUG = 3
+};
+
+struct LogCategory {
+    char name[LOG_CATEGORY_NAME];
+    std::atomic<int> level;
+    std::atomic<uint32_t> sample_every;     // 1: sem amostragem
+    std::atomic<uint64_t> sample_counter;
+    std::atomic<uint64_t> suppressed;
+};
+
+// Registro só cresce; a última entrada recebe as categorias excedentes
+struct LogCategoryRegistry {
+    LogCategory categories[LOG_MAX_CATEGORIES];
+    std::atomic<int> count;
+    std::mutex mutex;
+    std::atomic<int> default_level;
+    std::atomic<uint32_t> default_sample;
+    
+    LogCategoryRegistry() : count(0), default_level(LOG_DEBUG), default_sample(1) {
+        for (int i = 0; i < LOG_MAX_CATEGORIES; i++) {
+            categories[i].name[0] = '\0';
+            categories[i].level.store(LOG_DEBUG, std::memory_order_relaxed);
+            categories[i].sample_every.store(1, std::memory_order_relaxed);
+            categories[i].sample_counter.store(0, std::memory_order_relaxed);
+            categories[i].suppressed.store(0, std::memory_order_relaxed);
+        }
+    }
+};
+
+inline LogCategoryRegistry& logCategories() {
+    static LogCategoryRegistry* registry = new LogCategoryRegistry();
+    return *registry;
+}
+
+inline const char* logLevelName(int level) {
+    switch (level) {
+        case LOG_OFF: return "off";
+        case LOG_ERROR: return "error";
+        case LOG_WARN: return "warn";
+        case LOG_INFO: return "info";
+        default: return "debug";
+    }
+}
+
+// Função para converter o nome de um nível; false se desconhecido
+inline bool logParseLevel(const std::string& name, int& level) {
+    static const char* names[] = { "off", "error", "warn", "info", "debug" };
+    for (int i = 0; i < 5; i++) {
+        if (name == names[i]) {
+            level = i - 1;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Função para obter (ou registrar) a categoria de um tipo de evento
+inline LogCategory& logCategory(const char* name) {
+    LogCategoryRegistry& registry = logCategories();
+    std::lock_guard<std::mutex> guard(registry.mutex);
+    int count = registry.count.load(std::memory_order_relaxed);
+    for (int i = 0; i < count; i++) {
+        if (strncmp(registry.categories[i].name, name, LOG_CATEGORY_NAME - 1) == 0) {
+            return registry.categories[i];
+        }
+    }
+    if (count == LOG_MAX_CATEGORIES) {
+        return registry.categories[LOG_MAX_CATEGORIES - 1];
+    }
+    
+    LogCategory& category = registry.categories[count];
+    strncpy(category.name, count == LOG_MAX_CATEGORIES - 1 ? "other" : name, LOG_CATEGORY_NAME - 1);
+    category.name[LOG_CATEGORY_NAME - 1] = '\0';
+    category.level.store(registry.default_level.load(), std::memory_order_relaxed);
+    category.sample_every.store(registry.default_sample.load(), std::memory_order_relaxed);
+    registry.count.store(count + 1, std::memory_order_release);
+    return category;
+}
+
+// Cache por thread tipo -> categoria para os wrappers, que recebem o tipo
+// como std::string a cada evento
+inline LogCategory& logCategory(const std::string& name) {
+    static thread_local std::unordered_map<std::string, LogCategory*> cache;
+    std::unordered_map<std::string, LogCategory*>::iterator found = cache.find(name);
+    if (found != cache.end()) {
+        return *found->second;
+    }
+    LogCategory& category = logCategory(name.c_str());
+    cache[name] = &category;
+    return category;
+}
+
+// Nível de um evento emitido sem LOG_EVENT, deduzido do tipo
+inline int logTypeLevel(const std::string& type) {
+    if (type == "error") {
+        return LOG_ERROR;
+    }
+    if (type == "warning") {
+        return LOG_WARN;
+    }
+    return LOG_INFO;
+}
+
+// Marca o evento corrente da thread como já aprovado por LOG_EVENT, para que
+// o wrapper não aplique o filtro (e a amostragem) uma segunda vez
+inline bool& logPreapproved() {
+    static thread_local bool preapproved = false;
+    return preapproved;
+}
+
+// Função para decidir se um evento da categoria deve ser emitido
+inline bool logEnabled(LogCategory& category, int level) {
+    if (level > category.level.load(std::memory_order_relaxed)) {
+        category.suppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    uint32_t every = category.sample_every.load(std::memory_order_relaxed);
+    if (every > 1 && category.sample_counter.fetch_add(1, std::memory_order_relaxed) % every != 0) {
+        category.suppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+// Filtro dos wrappers logEvent
+inline bool logAccept(const std::string& type) {
+    bool& preapproved = logPreapproved();
+    if (preapproved) {
+        preapproved = false;
+        return true;
+    }
+    return logEnabled(logCategory(type), logTypeLevel(type));
+}
+
+#define LOG_IF(level, type, statement) \
+    do { \
+        static LogCategory& log_category_ = logCategory(type); \
+        if (logEnabled(log_category_, level)) { \
+            statement; \
+        } \
+    } while (0)
+
+#define LOG_EVENT(level, type, ...) \
+    LOG_IF(level, type, logPreapproved() = true; logEvent(type, __VA_ARGS__))
+
+// Função para aplicar nível ou amostragem a uma categoria ou a todas
+inline void logApplyLevel(const std::string& target, int level, bool set_level, uint32_t sample) {
+    LogCategoryRegistry& registry = logCategories();
+    if (target == "all") {
+        std::lock_guard<std::mutex> guard(registry.mutex);
+        if (set_level) {
+            registry.default_level.store(level);
+        } else {
+            registry.default_sample.store(sample);
+        }
+        int count = registry.count.load(std::memory_order_relaxed);
+        for (int i = 0; i < count; i++) {
+            if (set_level) {
+                registry.categories[i].level.store(level, std::memory_order_relaxed);
+            } else {
+                registry.categories[i].sample_every.store(sample, std::memory_order_relaxed);
+            }
+        }
+        return;
+    }
+    
+    LogCategory& category = logCategory(target.c_str());
+    if (set_level) {
+        category.level.store(level, std::memory_order_relaxed);
+    } else {
+        category.sample_every.store(sample, std::memory_order_relaxed);
+    }
+}
+
+// Função para emitir o estado das categorias
+inline void logReportLevels() {
+    LogCategoryRegistry& registry = logCategories();
+    std::string fields;
+    {
+        std::lock_guard<std::mutex> guard(registry.mutex);
+        fields = "\"default_level\":\"" + std::string(logLevelName(registry.default_level.load())) +
+                 "\",\"default_sample\":" + std::to_string(registry.default_sample.load()) +
+                 ",\"categories\":[";
+        int count = registry.count.load(std::memory_order_relaxed);
+        for (int i = 0; i < count; i++) {
+            LogCategory& category = registry.categories[i];
+            if (i > 0) {
+                fields += ",";
+            }
+            fields += "{\"name\":\"" + logEscape(category.name) +
+                      "\",\"level\":\"" + logLevelName(category.level.load(std::memory_order_relaxed)) +
+                      "\",\"sample\":" + std::to_string(category.sample_every.load(std::memory_order_relaxed)) +
+                      ",\"suppressed\":" + std::to_string(category.suppressed.load(std::memory_order_relaxed)) + "}";
+        }
+        fields += "]";
+    }
+    
+    LogLine& line = logBegin("log_levels");
+    logString(line, "component", "logger");
+    logString(line, "message", "Níveis de log por categoria");
+    logFields(line, fields);
+    logEnd(line);
+}
+
+inline void logCommandError(const std::string& message) {
+    LogLine& line = logBegin("error");
+    logString(line, "component", "logger");
+    logString(line, "message", message);
+    logString(line, "data", "uso: loglevel [<categoria|all>] [off|error|warn|info|debug | sample <n>]");
+    logEnd(line);
+}
+
+// Função para tratar o comando "loglevel"; args é o texto após o comando
+inline void logLevelCommand(const std::string& args) {
+    std::istringstream input(args);
+    std::vector<std::string> words;
+    std::string word;
+    while (input >> word) {
+        words.push_back(word);
+    }
+    
+    int level = LOG_DEBUG;
+    if (words.size() == 1 && logParseLevel(words[0], level)) {
+        logApplyLevel("all", level, true, 1);
+    } else if (words.size() == 2 && logParseLevel(words[1], level)) {
+        logApplyLevel(words[0], level, true, 1);
+    } else if (words.size() == 3 && words[1] == "sample") {
+        long sample = strtol(words[2].c_str(), nullptr, 10);
+        if (sample < 1 || sample > 1000000) {
+            logCommandError("Taxa de amostragem inválida: " + words[2]);
+            return;
+        }
+        logApplyLevel(words[0], 0, false, (uint32_t)sample);
+    } else if (!words.empty()) {
+        logCommandError("Comando loglevel inválido:" + args);
+        return;
+    }
+    logReportLevels();
+}
+
+// Função para configurar o logger a partir da linha de comando. Consome
+// (remove de argv) --format=json|binary, --log-policy=block|drop_oldest|sample,
+// --log-level=<nível> e --log-sync, para que o parser de cada programa não as
+// veja. Sem --log-sync, o modo é assíncrono; sem --log-policy, block.
+inline void logInit(int& argc, char* argv[]) {
+    LogPolicy policy = LOG_POLICY_BLOCK;
+    bool sync = false;
+    int level = LOG_DEBUG;
+    int kept = 1;
+    
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--log-sync") {
+            sync = true;
+        } else if (arg.find("--log-level=") == 0 && logParseLevel(arg.substr(12), level)) {
+            logCategories().default_level.store(level);
+        } else if (arg == "--format=json") {
+            logFormat() = LOG_FORMAT_JSON;
+        } else if (arg == "--format=binary") {
+            logFormat() = LOG_FORMAT_BINARY;
+        } else if (arg == "--log-policy=block") {
+            policy = LOG_POLICY_BLOCK;
+        } else if (arg == "--log-policy=drop_oldest") {
+            policy = LOG_POLICY_DROP_OLDEST;
+        } else if (arg == "--log-policy=sample") {
+            policy = LOG_POLICY_SAMPLE;
+        } else {
+            argv[kept++] = argv[i];
+        }
+    }
+    argc = kept;
+    argv[argc] = nullptr;
+    
+    logPid() = getpid();
+    logStringTable().owner = logPid();
+    pthread_atfork(logForkPrepare, logForkParent, logForkChild);
+    atexit(logShutdown);
+    
+    if (logFormat() == LOG_FORMAT_BINARY) {
+        logWriteStreamHeader();
+    }
+    if (!sync) {
+        logStartAsync(policy);
+    }
+}
+
+#endif
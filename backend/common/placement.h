@@ -0,0 +1,391 @@
+#ifndef COMMON_PLACEMENT_H
+#define COMMON_PLACEMENT_H
+
+// Posicionamento de processos, threads e memória nos hosts com vários nós NUMA.
+//
+// Opções de linha de comando (consumidas por placementInit):
+//     --cpu=<lista>         fixa o processo/threads nas CPUs da lista (ex.: 2,3 ou 0-3);
+//                           o índice i (0 = principal, 1.. = filhos/workers) usa a
+//                           CPU lista[i % tamanho]
+//     --numa-node=<n>       política de memória MPOL_BIND no nó; sem --cpu, usa as
+//                           CPUs do próprio nó
+//
+// Segmentos compartilhados e buffers grandes passam por placementBindMemory /
+// placementPrefault: mbind para o nó escolhido e pré-falta no primeiro toque,
+// já com a thread fixada. As chamadas de mbind/set_mempolicy são syscalls
+// diretas, sem depender da libnuma.
+//
+// Comando (ver placementTopologyCommand): topology — lê /sys e sugere
+// posicionamentos para um par produtor/consumidor.
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <pthread.h>
+#include <sched.h>
+#include <sstream>
+#include <string>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <vector>
+#include "log.h"
+
+#define PLACEMENT_NODE_PATH "/sys/devices/system/node"
+#define PLACEMENT_CPU_PATH "/sys/devices/system/cpu"
+#define PLACEMENT_MAX_NODES 64
+
+// Constantes de <numaif.h> (evita depender do pacote da libnuma)
+#define PLACEMENT_MPOL_BIND 2
+#define PLACEMENT_MPOL_MF_MOVE (1 << 1)
+
+#ifndef MADV_POPULATE_WRITE
+#define MADV_POPULATE_WRITE 23
+#endif
+
+// Configuração escolhida na linha de comando
+struct PlacementConfig {
+    std::vector<int> cpus;      // CPUs para fixação (vazio = sem fixação)
+    bool node_wide;             // CPUs vindas do nó: cada thread pode usar todas
+    int numa_node;              // nó da política de memória (-1 = padrão do kernel)
+    bool memory_bound;          // set_mempolicy aplicada ao processo
+    
+    PlacementConfig() : node_wide(false), numa_node(-1), memory_bound(false) {}
+};
+
+inline PlacementConfig& placementConfig() {
+    static PlacementConfig config;
+    return config;
+}
+
+inline std::string placementReadFile(const std::string& path) {
+    std::ifstream in(path.c_str());
+    std::string text;
+    std::getline(in, text);
+    return text;
+}
+
+// Converte listas no formato do kernel ("0-3,8,10-11") em CPUs/nós
+inline bool placementParseList(const std::string& text, std::vector<int>& out) {
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (item.empty()) {
+            continue;
+        }
+        char* end = nullptr;
+        long first = strtol(item.c_str(), &end, 10);
+        long last = first;
+        if (end == item.c_str() || first < 0) {
+            return false;
+        }
+        if (*end == '-') {
+            const char* rest = end + 1;
+            last = strtol(rest, &end, 10);
+            if (end == rest || last < first) {
+                return false;
+            }
+        }
+        if (*end != '\0' || last >= CPU_SETSIZE) {
+            return false;
+        }
+        for (long i = first; i <= last; i++) {
+            out.push_back((int)i);
+        }
+    }
+    return !out.empty();
+}
+
+inline std::string placementFormatList(const std::vector<int>& values) {
+    std::string text;
+    for (size_t i = 0; i < values.size(); i++) {
+        text += (i ? "," : "") + std::to_string(values[i]);
+    }
+    return text;
+}
+
+// Nós NUMA online; sem suporte a NUMA no kernel, um único nó 0
+inline std::vector<int> placementNodes() {
+    std::vector<int> nodes;
+    if (!placementParseList(placementReadFile(PLACEMENT_NODE_PATH "/online"), nodes)) {
+        nodes.assign(1, 0);
+    }
+    return nodes;
+}
+
+inline std::vector<int> placementNodeCpus(int node) {
+    std::vector<int> cpus;
+    if (!placementParseList(placementReadFile(PLACEMENT_NODE_PATH "/node" + std::to_string(node) + "/cpulist"), cpus)) {
+        cpus.clear();
+        placementParseList(placementReadFile(PLACEMENT_CPU_PATH "/online"), cpus);
+    }
+    return cpus;
+}
+
+inline void placementEmit(const char* type, const char* role, const std::string& message,
+                          const std::string& data) {
+    LogLine& line = logBegin(type);
+    logString(line, "process", role);
+    logInt(line, "pid", getpid());
+    logString(line, "message", message);
+    if (!data.empty()) {
+        logString(line, "data", data);
+    }
+    logEnd(line);
+}
+
+// Função para fixar a thread atual; index escolhe a CPU da lista --cpu (só com
+// --numa-node, a thread fica livre entre as CPUs do nó). Retorna a CPU fixada ou -1
+inline int placementApply(int index, const char* role) {
+    PlacementConfig& config = placementConfig();
+    if (config.cpus.empty()) {
+        return -1;
+    }
+    
+    int cpu = config.cpus[index % config.cpus.size()];
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (config.node_wide) {
+        for (size_t i = 0; i < config.cpus.size(); i++) {
+            CPU_SET(config.cpus[i], &set);
+        }
+    } else {
+        CPU_SET(cpu, &set);
+    }
+    int rc = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (rc != 0) {
+        placementEmit("error", role, "Erro ao fixar thread na CPU: " + std::string(strerror(rc)),
+                      "cpu=" + std::to_string(cpu));
+        return -1;
+    }
+    if (config.node_wide) {
+        return -1;
+    }
+    if (index > 0) {
+        placementEmit("placement", role, "Thread fixada na CPU",
+                      "cpu=" + std::to_string(cpu) + " index=" + std::to_string(index));
+    }
+    return cpu;
+}
+
+inline unsigned long placementNodeMask(int node) {
+    return 1UL << node;
+}
+
+// Função para pré-faltar uma região no primeiro toque desta thread (já fixada),
+// sem alterar o conteúdo; sem MADV_POPULATE_WRITE (Linux < 5.14) lê cada página
+inline void placementPrefault(void* addr, size_t length) {
+    if (placementConfig().cpus.empty() && placementConfig().numa_node < 0) {
+        return;
+    }
+    uintptr_t page = (uintptr_t)sysconf(_SC_PAGESIZE);
+    uintptr_t start = (uintptr_t)addr & ~(page - 1);
+    if (madvise((void*)start, length + ((uintptr_t)addr - start), MADV_POPULATE_WRITE) == 0) {
+        return;
+    }
+    volatile const char* bytes = static_cast<const char*>(addr);
+    for (size_t offset = 0; offset < length; offset += page) {
+        (void)bytes[offset];
+    }
+}
+
+// Função para ligar uma região ao nó escolhido (mbind com MPOL_MF_MOVE,
+// migrando páginas já presentes) e pré-faltá-la
+inline void placementBindMemory(void* addr, size_t length, const char* role) {
+    PlacementConfig& config = placementConfig();
+    if (config.numa_node >= 0 && length > 0) {
+        // mbind exige endereço alinhado à página; o comprimento é arredondado pelo kernel
+        uintptr_t page = (uintptr_t)sysconf(_SC_PAGESIZE);
+        uintptr_t start = (uintptr_t)addr & ~(page - 1);
+        size_t span = length + ((uintptr_t)addr - start);
+        unsigned long mask = placementNodeMask(config.numa_node);
+        if (syscall(SYS_mbind, start, span, PLACEMENT_MPOL_BIND, &mask,
+                    (unsigned long)PLACEMENT_MAX_NODES + 1, PLACEMENT_MPOL_MF_MOVE) != 0) {
+            placementEmit("warning", role, "mbind falhou - memória segue a política padrão: " +
+                          std::string(strerror(errno)), "node=" + std::to_string(config.numa_node));
+        }
+    }
+    placementPrefault(addr, length);
+}
+
+// Resumo do posicionamento para o evento de inicialização
+inline std::string placementSummary() {
+    PlacementConfig& config = placementConfig();
+    std::string text = "cpus=" + (config.cpus.empty() ? std::string("any") : placementFormatList(config.cpus));
+    text += " numa_node=" + (config.numa_node < 0 ? std::string("any") : std::to_string(config.numa_node));
+    text += " numa_nodes=" + std::to_string(placementNodes().size());
+    text += " online_cpus=" + std::to_string(sysconf(_SC_NPROCESSORS_ONLN));
+    return text;
+}
+
+// Informações de uma CPU lidas de /sys
+struct PlacementCpu {
+    int cpu;
+    int node;
+    int package;
+    int core;
+    std::string siblings;
+};
+
+inline int placementReadInt(const std::string& path, int fallback) {
+    std::string text = placementReadFile(path);
+    return text.empty() ? fallback : atoi(text.c_str());
+}
+
+// Função para emitir o evento "topology": nós, CPUs e uma sugestão de
+// posicionamento para um par produtor/consumidor
+inline void placementTopologyCommand(const char* component) {
+    std::vector<int> nodes = placementNodes();
+    std::vector<PlacementCpu> cpus;
+    std::stringstream out;
+    
+    out << "\"nodes\":[";
+    for (size_t n = 0; n < nodes.size(); n++) {
+        int node = nodes[n];
+        std::string base = PLACEMENT_NODE_PATH "/node" + std::to_string(node);
+        std::vector<int> node_cpus = placementNodeCpus(node);
+        
+        // meminfo do nó: "Node 0 MemTotal:  16303592 kB"
+        uint64_t mem_total = 0;
+        uint64_t mem_free = 0;
+        std::ifstream meminfo((base + "/meminfo").c_str());
+        std::string line;
+        while (std::getline(meminfo, line)) {
+            std::string key;
+            uint64_t value = 0;
+            std::stringstream fields(line);
+            std::string skip;
+            fields >> skip >> skip >> key >> value;
+            if (key == "MemTotal:") {
+                mem_total = value;
+            } else if (key == "MemFree:") {
+                mem_free = value;
+            }
+        }
+        
+        out << (n ? "," : "") << "{\"node\":" << node
+            << ",\"cpus\":\"" << placementFormatList(node_cpus) << "\""
+            << ",\"mem_total_kb\":" << mem_total
+            << ",\"mem_free_kb\":" << mem_free
+            << ",\"distances\":\"" << logEscape(placementReadFile(base + "/distance")) << "\"}";
+        
+        for (size_t c = 0; c < node_cpus.size(); c++) {
+            std::string topology = PLACEMENT_CPU_PATH "/cpu" + std::to_string(node_cpus[c]) + "/topology/";
+            PlacementCpu info;
+            info.cpu = node_cpus[c];
+            info.node = node;
+            info.package = placementReadInt(topology + "physical_package_id", 0);
+            info.core = placementReadInt(topology + "core_id", info.cpu);
+            info.siblings = placementReadFile(topology + "thread_siblings_list");
+            cpus.push_back(info);
+        }
+    }
+    out << "],\"cpus\":[";
+    for (size_t c = 0; c < cpus.size(); c++) {
+        out << (c ? "," : "") << "{\"cpu\":" << cpus[c].cpu << ",\"node\":" << cpus[c].node
+            << ",\"package\":" << cpus[c].package << ",\"core\":" << cpus[c].core
+            << ",\"siblings\":\"" << cpus[c].siblings << "\"}";
+    }
+    out << "]";
+    
+    // Sugestão: o nó com mais CPUs, produtor e consumidor em núcleos físicos
+    // distintos (irmãs SMT dividem as unidades de execução)
+    int best_node = nodes[0];
+    size_t best_count = 0;
+    for (size_t n = 0; n < nodes.size(); n++) {
+        size_t count = placementNodeCpus(nodes[n]).size();
+        if (count > best_count) {
+            best_count = count;
+            best_node = nodes[n];
+        }
+    }
+    std::vector<int> pair;
+    std::map<std::pair<int, int>, bool> used_cores;
+    for (size_t c = 0; c < cpus.size() && pair.size() < 2; c++) {
+        std::pair<int, int> core(cpus[c].package, cpus[c].core);
+        if (cpus[c].node == best_node && !used_cores[core]) {
+            used_cores[core] = true;
+            pair.push_back(cpus[c].cpu);
+        }
+    }
+    std::string note = "núcleos físicos distintos no mesmo nó";
+    if (pair.size() < 2) {
+        std::vector<int> node_cpus = placementNodeCpus(best_node);
+        pair.assign(node_cpus.begin(), node_cpus.begin() + std::min<size_t>(2, node_cpus.size()));
+        note = pair.size() < 2 ? "apenas uma CPU: produtor e consumidor dividem o núcleo"
+                               : "irmãs SMT: mesmo núcleo físico";
+    }
+    out << ",\"suggestion\":{\"options\":\"--numa-node=" << best_node << " --cpu=" << placementFormatList(pair)
+        << "\",\"note\":\"" << note << "\"}";
+    
+    cpu_set_t current;
+    std::vector<int> affinity;
+    if (sched_getaffinity(0, sizeof(current), &current) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+            if (CPU_ISSET(cpu, &current)) {
+                affinity.push_back(cpu);
+            }
+        }
+    }
+    out << ",\"affinity\":\"" << placementFormatList(affinity) << "\"";
+    
+    LogLine& line = logBegin("topology");
+    logString(line, "component", component);
+    logString(line, "message", "Topologia de CPUs e nós NUMA");
+    logFields(line, out.str());
+    logEnd(line);
+}
+
+// Função para consumir --cpu e --numa-node de argv, aplicar a política de
+// memória ao processo e fixar a thread principal (índice 0)
+inline void placementInit(int& argc, char* argv[], const char* role) {
+    PlacementConfig& config = placementConfig();
+    int kept = 1;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.find("--cpu=") == 0) {
+            config.cpus.clear();
+            if (!placementParseList(arg.substr(6), config.cpus)) {
+                config.cpus.clear();
+                placementEmit("error", role, "Lista de CPUs inválida: " + arg.substr(6), "ex.: --cpu=2,3 ou --cpu=0-3");
+            }
+        } else if (arg.find("--numa-node=") == 0) {
+            config.numa_node = atoi(arg.substr(12).c_str());
+            std::vector<int> nodes = placementNodes();
+            if (std::find(nodes.begin(), nodes.end(), config.numa_node) == nodes.end() ||
+                config.numa_node >= PLACEMENT_MAX_NODES) {
+                placementEmit("error", role, "Nó NUMA inexistente: " + arg.substr(12),
+                              "nodes=" + placementFormatList(nodes));
+                config.numa_node = -1;
+            }
+        } else {
+            argv[kept++] = argv[i];
+        }
+    }
+    argc = kept;
+    argv[argc] = nullptr;
+    
+    if (config.numa_node >= 0) {
+        if (config.cpus.empty()) {
+            config.cpus = placementNodeCpus(config.numa_node);
+            config.node_wide = true;
+        }
+        unsigned long mask = placementNodeMask(config.numa_node);
+        if (syscall(SYS_set_mempolicy, PLACEMENT_MPOL_BIND, &mask, (unsigned long)PLACEMENT_MAX_NODES + 1) == 0) {
+            config.memory_bound = true;
+        } else {
+            placementEmit("warning", role, "set_mempolicy falhou - memória segue a política padrão: " +
+                          std::string(strerror(errno)), "node=" + std::to_string(config.numa_node));
+        }
+    }
+    // Sem a fixação da thread principal o resumo não deve anunciar as CPUs
+    if (placementApply(0, role) < 0 && !config.node_wide) {
+        config.cpus.clear();
+    }
+}
+
+#endif
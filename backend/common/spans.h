@@ -0,0 +1,279 @@
+#ifndef COMMON_SPANS_H
+#define COMMON_SPANS_H
+
+// Medição de spans nos caminhos quentes: duração de cada primitiva de IPC
+// (obter lock, copiar, syscall, acordar) em histogramas por operação.
+//
+// Desligado por padrão; o custo de um span desligado é uma leitura relaxed
+// e um desvio. Ligado, cada span lê o TSC (rdtsc, quando invariante) ou o
+// CLOCK_MONOTONIC e registra no histograma da própria thread, sem disputa
+// entre threads; o comando "stats" junta as threads e relata percentis em ns.
+//
+// Uso:
+//     static SpanOp& lock_span = spanOp("shm.lock");
+//     uint64_t start = spanStart();
+//     ...
+//     spanEnd(lock_span, start);
+//
+// Comando (ver spanCommand): stats | stats on | stats off | stats reset
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "histogram.h"
+#include "log.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#include <cpuid.h>
+#define SPAN_HAVE_TSC 1
+#endif
+
+#define SPAN_MAX_OPS 32
+#define SPAN_OP_NAME 32
+#define SPAN_CALIBRATION_NS 2000000         // janela de calibração do TSC
+
+struct SpanOp {
+    int id;
+    char name[SPAN_OP_NAME];
+};
+
+// Histogramas de uma thread; o mutex só é disputado durante um relatório
+struct SpanThread {
+    std::mutex mutex;
+    Histogram* histograms[SPAN_MAX_OPS];
+    
+    SpanThread() {
+        memset(histograms, 0, sizeof(histograms));
+    }
+};
+
+struct SpanRegistry {
+    std::atomic<bool> enabled;
+    bool use_tsc;
+    double ns_per_tick;
+    std::mutex mutex;
+    SpanOp ops[SPAN_MAX_OPS];
+    int op_count;
+    std::vector<SpanThread*> threads;       // nunca liberadas: os dados sobrevivem à thread
+    
+    SpanRegistry() : enabled(false), use_tsc(false), ns_per_tick(1.0), op_count(0) {}
+};
+
+inline SpanRegistry& spanRegistry() {
+    static SpanRegistry* registry = new SpanRegistry();
+    return *registry;
+}
+
+inline uint64_t spanMonotonicNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+inline uint64_t spanTicks() {
+#ifdef SPAN_HAVE_TSC
+    if (spanRegistry().use_tsc) {
+        return __rdtsc();
+    }
+#endif
+    return spanMonotonicNs();
+}
+
+// Função para registrar (ou obter) uma operação pelo nome
+inline SpanOp& spanOp(const char* name) {
+    SpanRegistry& registry = spanRegistry();
+    std::lock_guard<std::mutex> guard(registry.mutex);
+    for (int i = 0; i < registry.op_count; i++) {
+        if (strncmp(registry.ops[i].name, name, SPAN_OP_NAME - 1) == 0) {
+            return registry.ops[i];
+        }
+    }
+    if (registry.op_count == SPAN_MAX_OPS) {
+        return registry.ops[SPAN_MAX_OPS - 1];     // excedentes somam na última
+    }
+    SpanOp& op = registry.ops[registry.op_count];
+    op.id = registry.op_count++;
+    strncpy(op.name, name, SPAN_OP_NAME - 1);
+    op.name[SPAN_OP_NAME - 1] = '\0';
+    return op;
+}
+
+inline SpanThread& spanThread() {
+    static thread_local SpanThread* thread = nullptr;
+    if (!thread) {
+        thread = new SpanThread();
+        SpanRegistry& registry = spanRegistry();
+        std::lock_guard<std::mutex> guard(registry.mutex);
+        registry.threads.push_back(thread);
+    }
+    return *thread;
+}
+
+// Início de um span; 0 quando a medição está desligada
+inline uint64_t spanStart() {
+    if (!spanRegistry().enabled.load(std::memory_order_relaxed)) {
+        return 0;
+    }
+    return spanTicks();
+}
+
+inline void spanRecordTicks(SpanOp& op, uint64_t ticks) {
+    SpanThread& thread = spanThread();
+    std::lock_guard<std::mutex> guard(thread.mutex);
+    Histogram*& histogram = thread.histograms[op.id];
+    if (!histogram) {
+        histogram = new Histogram();
+    }
+    histogramRecord(*histogram, ticks);
+}
+
+inline void spanEnd(SpanOp& op, uint64_t start) {
+    if (start == 0) {
+        return;
+    }
+    uint64_t end = spanTicks();
+    spanRecordTicks(op, end > start ? end - start : 0);
+}
+
+// Registra uma duração já medida em ns, como a latência entre processos
+// calculada com timestamps CLOCK_MONOTONIC do produtor
+inline void spanRecordNs(SpanOp& op, uint64_t ns) {
+    SpanRegistry& registry = spanRegistry();
+    if (!registry.enabled.load(std::memory_order_relaxed)) {
+        return;
+    }
+    spanRecordTicks(op, registry.use_tsc ? (uint64_t)(ns / registry.ns_per_tick) : ns);
+}
+
+// Função para escolher o relógio e calibrar o TSC contra o CLOCK_MONOTONIC
+inline void spanCalibrate(SpanRegistry& registry) {
+    registry.use_tsc = false;
+    registry.ns_per_tick = 1.0;
+#ifdef SPAN_HAVE_TSC
+    // Só o TSC invariante (CPUID 0x80000007, EDX bit 8) tem frequência constante
+    unsigned eax, ebx, ecx, edx;
+    if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) || !(edx & (1u << 8))) {
+        return;
+    }
+    uint64_t ns_start = spanMonotonicNs();
+    uint64_t tsc_start = __rdtsc();
+    uint64_t ns_end;
+    do {
+        ns_end = spanMonotonicNs();
+    } while (ns_end - ns_start < SPAN_CALIBRATION_NS);
+    uint64_t tsc_end = __rdtsc();
+    if (tsc_end > tsc_start) {
+        registry.ns_per_tick = (double)(ns_end - ns_start) / (double)(tsc_end - tsc_start);
+        registry.use_tsc = true;
+    }
+#endif
+}
+
+inline void spanSetEnabled(bool enabled) {
+    SpanRegistry& registry = spanRegistry();
+    if (enabled && !registry.enabled.load()) {
+        spanCalibrate(registry);
+    }
+    registry.enabled.store(enabled);
+}
+
+// Função para zerar os histogramas de todas as threads
+inline void spanReset() {
+    SpanRegistry& registry = spanRegistry();
+    std::lock_guard<std::mutex> guard(registry.mutex);
+    for (size_t t = 0; t < registry.threads.size(); t++) {
+        std::lock_guard<std::mutex> thread_guard(registry.threads[t]->mutex);
+        for (int i = 0; i < SPAN_MAX_OPS; i++) {
+            if (registry.threads[t]->histograms[i]) {
+                histogramReset(*registry.threads[t]->histograms[i]);
+            }
+        }
+    }
+}
+
+// Função para emitir os percentis por operação como evento "stats"
+inline void spanReport(const char* component) {
+    SpanRegistry& registry = spanRegistry();
+    Histogram* merged = new Histogram();
+    std::string fields;
+    
+    {
+        std::lock_guard<std::mutex> guard(registry.mutex);
+        fields = std::string("\"enabled\":") + (registry.enabled.load() ? "true" : "false") +
+                 ",\"clock\":\"" + (registry.use_tsc ? "rdtsc" : "monotonic") + "\",\"spans\":{";
+        bool first = true;
+        for (int i = 0; i < registry.op_count; i++) {
+            histogramReset(*merged);
+            for (size_t t = 0; t < registry.threads.size(); t++) {
+                std::lock_guard<std::mutex> thread_guard(registry.threads[t]->mutex);
+                if (registry.threads[t]->histograms[i]) {
+                    histogramMerge(*merged, *registry.threads[t]->histograms[i]);
+                }
+            }
+            if (merged->total == 0) {
+                continue;
+            }
+            
+            double scale = registry.ns_per_tick;
+            fields += std::string(first ? "" : ",") + "\"" + registry.ops[i].name + "\":{" +
+                      "\"count\":" + std::to_string(merged->total) +
+                      ",\"mean_ns\":" + std::to_string((uint64_t)(histogramMean(*merged) * scale)) +
+                      ",\"p50_ns\":" + std::to_string((uint64_t)(histogramPercentile(*merged, 50) * scale)) +
+                      ",\"p90_ns\":" + std::to_string((uint64_t)(histogramPercentile(*merged, 90) * scale)) +
+                      ",\"p99_ns\":" + std::to_string((uint64_t)(histogramPercentile(*merged, 99) * scale)) +
+                      ",\"p999_ns\":" + std::to_string((uint64_t)(histogramPercentile(*merged, 99.9) * scale)) +
+                      ",\"max_ns\":" + std::to_string((uint64_t)(merged->max * scale)) + "}";
+            first = false;
+        }
+        fields += "}";
+    }
+    delete merged;
+    
+    LogLine& line = logBegin("stats");
+    logString(line, "component", component);
+    logString(line, "message", "Latência por operação de IPC");
+    logFields(line, fields);
+    logEnd(line);
+}
+
+// Função para tratar o comando "stats"; args é o texto após o comando
+inline void spanCommand(const std::string& args, const char* component) {
+    size_t first = args.find_first_not_of(' ');
+    std::string action = first == std::string::npos ? "" : args.substr(first);
+    if (action == "on") {
+        spanSetEnabled(true);
+    } else if (action == "off") {
+        spanSetEnabled(false);
+    } else if (action == "reset") {
+        spanReset();
+    } else if (!action.empty()) {
+        LogLine& line = logBegin("error");
+        logString(line, "component", component);
+        logString(line, "message", "Comando stats inválido: " + action);
+        logString(line, "data", "uso: stats [on|off|reset]");
+        logEnd(line);
+        return;
+    }
+    spanReport(component);
+}
+
+// Função para consumir --spans de argv (liga a medição desde o início)
+inline void spanInit(int& argc, char* argv[]) {
+    int kept = 1;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--spans") == 0) {
+            spanSetEnabled(true);
+        } else {
+            argv[kept++] = argv[i];
+        }
+    }
+    argc = kept;
+    argv[argc] = nullptr;
+}
+
+#endif
@@ -0,0 +1,252 @@
+#ifndef COMMON_WAIT_H
+#define COMMON_WAIT_H
+
+// Estratégia de espera dos consumidores (pipes, sockets e memória compartilhada).
+//
+// Estratégias:
+//     block       bloqueia direto no kernel (futex, poll, epoll, semop) - padrão
+//     spin        busy-poll com pause até haver dados ou esgotar o prazo; nunca dorme
+//     spin_yield  busy-poll por spin_us, depois sched_yield a cada verificação
+//     adaptive    busy-poll por spin_us, depois bloqueia no kernel
+//
+// Cada ponto de espera chama waitSpin (ou waitPoll/waitEpoll, que já combinam as
+// duas fases) antes da chamada bloqueante. Com a medição de spans ligada, o
+// consumidor registra a latência de acordar - do timestamp CLOCK_MONOTONIC
+// gravado pelo produtor até a leitura - na operação "<ponto>.<estratégia>".
+//
+// Opções de linha de comando (consumidas por waitInit): --wait=<estratégia>,
+// --spin-us=<n>. Comando (ver waitCommand): wait [estratégia] [spin_us]
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <poll.h>
+#include <sched.h>
+#include <string>
+#include <sys/epoll.h>
+#include <unistd.h>
+#include "log.h"
+#include "spans.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#define WAIT_DEFAULT_SPIN_NS 50000          // janela de spin das estratégias spin_yield/adaptive
+#define WAIT_CLOCK_CHECK_MASK 63            // lê o relógio a cada 64 verificações
+
+enum WaitStrategy {
+    WAIT_BLOCK = 0,
+    WAIT_SPIN = 1,
+    WAIT_SPIN_YIELD = 2,
+    WAIT_ADAPTIVE = 3,
+    WAIT_STRATEGY_COUNT = 4
+};
+
+struct WaitConfig {
+    std::atomic<int> strategy;
+    std::atomic<uint64_t> spin_ns;
+    
+    WaitConfig() : strategy(WAIT_BLOCK), spin_ns(WAIT_DEFAULT_SPIN_NS) {}
+};
+
+inline WaitConfig& waitConfig() {
+    static WaitConfig config;
+    return config;
+}
+
+inline const char* waitStrategyName(int strategy) {
+    switch (strategy) {
+        case WAIT_SPIN: return "spin";
+        case WAIT_SPIN_YIELD: return "spin_yield";
+        case WAIT_ADAPTIVE: return "adaptive";
+        default: return "block";
+    }
+}
+
+inline bool waitParseStrategy(const std::string& name, int& strategy) {
+    for (int i = 0; i < WAIT_STRATEGY_COUNT; i++) {
+        if (name == waitStrategyName(i)) {
+            strategy = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Dica de spin para a CPU (libera recursos para o outro hyperthread)
+inline void waitPause() {
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#else
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+}
+
+// Fase sem bloqueio: verifica ready() conforme a estratégia. Retorna true se
+// ficou pronto; false quando o chamador deve bloquear no kernel (block,
+// adaptive após a janela) ou quando o prazo (timeout_ns < 0 = sem prazo) venceu
+template <typename Ready>
+inline bool waitSpin(Ready ready, int64_t timeout_ns) {
+    WaitConfig& config = waitConfig();
+    int strategy = config.strategy.load(std::memory_order_relaxed);
+    if (strategy == WAIT_BLOCK) {
+        return false;
+    }
+    
+    uint64_t start = spanMonotonicNs();
+    uint64_t spin_ns = config.spin_ns.load(std::memory_order_relaxed);
+    for (uint32_t i = 0;; i++) {
+        if (ready()) {
+            return true;
+        }
+        if ((i & WAIT_CLOCK_CHECK_MASK) != WAIT_CLOCK_CHECK_MASK) {
+            waitPause();
+            continue;
+        }
+        uint64_t elapsed = spanMonotonicNs() - start;
+        if (timeout_ns >= 0 && elapsed >= (uint64_t)timeout_ns) {
+            return false;
+        }
+        if (strategy == WAIT_SPIN || elapsed < spin_ns) {
+            waitPause();
+        } else if (strategy == WAIT_SPIN_YIELD) {
+            sched_yield();
+        } else {
+            return false;
+        }
+    }
+}
+
+// Tempo restante em ms para a fase bloqueante (arredondado para cima; -1 = sem prazo)
+inline int waitRemainingMs(int timeout_ms, uint64_t start_ns) {
+    if (timeout_ms < 0) {
+        return -1;
+    }
+    uint64_t elapsed = spanMonotonicNs() - start_ns;
+    uint64_t timeout_ns = (uint64_t)timeout_ms * 1000000ULL;
+    return elapsed >= timeout_ns ? 0 : (int)((timeout_ns - elapsed + 999999ULL) / 1000000ULL);
+}
+
+// poll com a estratégia configurada: verifica com timeout 0 durante o spin e
+// só então bloqueia pelo tempo restante. Mesmo retorno que poll
+inline int waitPoll(struct pollfd* fds, nfds_t count, int timeout_ms) {
+    uint64_t start = spanMonotonicNs();
+    int ready = 0;
+    if (waitSpin([&]() { ready = poll(fds, count, 0); return ready != 0; },
+                 timeout_ms < 0 ? -1 : (int64_t)timeout_ms * 1000000LL)) {
+        return ready;
+    }
+    return poll(fds, count, waitRemainingMs(timeout_ms, start));
+}
+
+// epoll_wait com a estratégia configurada (mesmo esquema de waitPoll)
+inline int waitEpoll(int epoll_fd, struct epoll_event* events, int max_events, int timeout_ms) {
+    uint64_t start = spanMonotonicNs();
+    int ready = 0;
+    if (waitSpin([&]() { ready = epoll_wait(epoll_fd, events, max_events, 0); return ready != 0; },
+                 timeout_ms < 0 ? -1 : (int64_t)timeout_ms * 1000000LL)) {
+        return ready;
+    }
+    return epoll_wait(epoll_fd, events, max_events, waitRemainingMs(timeout_ms, start));
+}
+
+// Ponto de espera com uma operação de span por estratégia
+struct WaitSite {
+    const char* name;
+    std::atomic<SpanOp*> ops[WAIT_STRATEGY_COUNT];
+    
+    explicit WaitSite(const char* name) : name(name) {
+        for (int i = 0; i < WAIT_STRATEGY_COUNT; i++) {
+            ops[i].store(nullptr);
+        }
+    }
+};
+
+// Função para registrar a latência de acordar desde published_ns (CLOCK_MONOTONIC
+// do produtor, comparável entre processos do mesmo host)
+inline void waitRecordWakeup(WaitSite& site, uint64_t published_ns) {
+    if (published_ns == 0 || !spanRegistry().enabled.load(std::memory_order_relaxed)) {
+        return;
+    }
+    uint64_t now = spanMonotonicNs();
+    int strategy = waitConfig().strategy.load(std::memory_order_relaxed);
+    SpanOp* op = site.ops[strategy].load(std::memory_order_acquire);
+    if (!op) {
+        op = &spanOp((std::string(site.name) + "." + waitStrategyName(strategy)).c_str());
+        site.ops[strategy].store(op, std::memory_order_release);
+    }
+    spanRecordNs(*op, now > published_ns ? now - published_ns : 0);
+}
+
+inline void waitReport(const char* component) {
+    WaitConfig& config = waitConfig();
+    LogLine& line = logBegin("wait");
+    logString(line, "component", component);
+    logString(line, "message", "Estratégia de espera dos consumidores");
+    logString(line, "strategy", waitStrategyName(config.strategy.load()));
+    logInt(line, "spin_us", (int64_t)(config.spin_ns.load() / 1000));
+    logEnd(line);
+}
+
+inline void waitError(const char* component, const std::string& message) {
+    LogLine& line = logBegin("error");
+    logString(line, "component", component);
+    logString(line, "message", message);
+    logString(line, "data", "uso: wait [block|spin|spin_yield|adaptive] [spin_us]");
+    logEnd(line);
+}
+
+// Função para tratar o comando "wait"; args é o texto após o comando
+inline void waitCommand(const std::string& args, const char* component) {
+    WaitConfig& config = waitConfig();
+    size_t first = args.find_first_not_of(' ');
+    std::string rest = first == std::string::npos ? "" : args.substr(first);
+    if (!rest.empty()) {
+        size_t space = rest.find(' ');
+        std::string name = rest.substr(0, space);
+        int strategy;
+        if (!waitParseStrategy(name, strategy)) {
+            waitError(component, "Estratégia de espera inválida: " + name);
+            return;
+        }
+        if (space != std::string::npos) {
+            char* end = nullptr;
+            long spin_us = strtol(rest.c_str() + space + 1, &end, 10);
+            if (spin_us < 0 || end == rest.c_str() + space + 1) {
+                waitError(component, "Janela de spin inválida: " + rest.substr(space + 1));
+                return;
+            }
+            config.spin_ns.store((uint64_t)spin_us * 1000ULL);
+        }
+        config.strategy.store(strategy);
+    }
+    waitReport(component);
+}
+
+// Função para consumir --wait= e --spin-us= de argv
+inline void waitInit(int& argc, char* argv[]) {
+    WaitConfig& config = waitConfig();
+    int kept = 1;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        int strategy;
+        if (arg.find("--wait=") == 0) {
+            if (waitParseStrategy(arg.substr(7), strategy)) {
+                config.strategy.store(strategy);
+            } else {
+                waitError("main", "Estratégia de espera inválida: " + arg.substr(7));
+            }
+        } else if (arg.find("--spin-us=") == 0) {
+            long spin_us = atol(arg.substr(10).c_str());
+            config.spin_ns.store((uint64_t)(spin_us > 0 ? spin_us : 0) * 1000ULL);
+        } else {
+            argv[kept++] = argv[i];
+        }
+    }
+    argc = kept;
+    argv[argc] = nullptr;
+}
+
+#endif
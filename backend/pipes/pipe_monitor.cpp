@@ -7,65 +7,116 @@
 #include <iomanip>
 #include <cerrno>
 #include <string>
+#include <functional>
+#include <algorithm>
 #include <fcntl.h>
+#include <poll.h>
+#include <sys/uio.h>
+#include <sys/ioctl.h>
+#include <vector>
+#include <cstdlib>
+#include <csignal>
+#include "log.h"
+#include "commands.h"
+#include "spans.h"
+#include "placement.h"
+#include "wait.h"
 
-// Função para obter timestamp formatado
-std::string getTimestamp() {
-    std::time_t now = std::time(nullptr);
-    std::tm* tm = std::localtime(&now);
-    
-    std::stringstream ss;
-    ss << std::put_time(tm, "%Y-%m-%d %H:%M:%S");
-    return ss.str();
-}
+// Configuração do canal de transferência em massa (zero-copy)
+#define BULK_PIPE_SIZE (1024 * 1024)     // capacidade desejada via F_SETPIPE_SZ
+#define BULK_CHUNK_SIZE (256 * 1024)     // bytes por vmsplice/splice
+#define BULK_IDLE_MS 200                 // ociosidade que encerra uma rajada no filho
+#define BULK_DRAIN_TIMEOUT_MS 5000       // espera máxima para o filho esvaziar o pipe de massa
+#define BULK_DRAIN_POLL_US 50            // intervalo entre verificações de FIONREAD
+#define READ_IDLE_MS 100                 // espera por mais dados antes de encerrar o comando read
+#define PAGE_SIZE_BYTES 4096
 
-// Função para escapar caracteres especiais em uma string JSON
-std::string escapeJson(const std::string& s) {
-    std::stringstream o;
-    for (char c : s) {
-        switch (c) {
-            case '"':  o << "\\\""; break;
-            case '\\': o << "\\\\"; break;
-            case '\b': o << "\\b";  break;
-            case '\f': o << "\\f";  break;
-            case '\n': o << "\\n";  break;
-            case '\r': o << "\\r";  break;
-            case '\t': o << "\\t";  break;
-            default:
-                if ('\x00' <= c && c <= '\x1f') {
-                    o << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c);
-                } else {
-                    o << c;
-                }
-        }
-    }
-    return o.str();
-}
+// Configuração do protocolo enquadrado do pipe de mensagens
+#define READ_CHUNK_SIZE (64 * 1024)      // bytes lidos por read() no filho
+#define MAX_FRAME_SIZE (16 * 1024 * 1024) // maior mensagem aceita
+#define MAX_REASSEMBLY_SIZE (MAX_FRAME_SIZE + sizeof(FrameHeader)) // limite do buffer do remontador
+
+// Configuração do pool de filhos
+#define MAX_POOL_SIZE 256
+#define POOL_STATS_INTERVAL 1000         // mensagens entre relatórios automáticos
 
 // Função para gerar JSON de evento
 void logEvent(const std::string& type, const std::string& message, 
               const std::string& process = "", pid_t pid = 0, 
               const std::string& data = "") {
-    std::stringstream json;
-    json << "{\"timestamp\":\"" << getTimestamp() << "\",\"type\":\"" << type << "\",\"process\":\"" << process << "\",\"pid\":" << pid << ",\"message\":\"" << escapeJson(message) << "\"";
+    if (!logAccept(type)) {
+        return;
+    }
+    LogLine& line = logBegin(type);
+    logString(line, "process", process);
+    logInt(line, "pid", pid);
+    logString(line, "message", message);
     if (!data.empty()) {
-        json << ",\"data\":\"" << escapeJson(data) << "\"";
+        logString(line, "data", data);
     }
-    json << "}" << std::endl;
-    std::cout << json.str();
-    std::cout.flush(); // Garante que o output seja enviado imediatamente
+    logEnd(line);
 }
 
+// Cabeçalho de cada mensagem no pipe: tamanho do payload, número de sequência e
+// instante do envio (CLOCK_MONOTONIC, para a latência de acordar do leitor)
+struct FrameHeader {
+    uint32_t length;
+    uint32_t sequence;
+    uint64_t sent_ns;
+};
+
+// Remontador de mensagens a partir de leituras de tamanho arbitrário: várias
+// mensagens podem chegar em um read() e uma mensagem pode chegar em vários
+struct FrameReassembler {
+    std::vector<char> buffer;
+    size_t start;                // início dos bytes ainda não consumidos
+    size_t end;                  // fim dos bytes já lidos
+    uint32_t expected_sequence;
+    bool corrupted;              // cabeçalho inválido: o fluxo perdeu o alinhamento
+    
+    FrameReassembler() : buffer(READ_CHUNK_SIZE), start(0), end(0),
+                        expected_sequence(0), corrupted(false) {}
+};
+
+// Filho de um pool, cada um com seu próprio pipe (visto pelo pai)
+struct PipeWorker {
+    int write_fd;
+    pid_t pid;
+    uint32_t next_sequence;
+    uint64_t messages;
+    uint64_t bytes;
+    
+    PipeWorker() : write_fd(-1), pid(-1), next_sequence(0), messages(0), bytes(0) {}
+};
+
+// Políticas de distribuição das mensagens entre os filhos do pool
+enum PoolPolicy {
+    POOL_ROUND_ROBIN,
+    POOL_KEY_HASH      // chave = texto antes do primeiro ':' (ou a mensagem inteira)
+};
+
 // Estrutura para gerenciar o estado do pipe
 struct PipeState {
     int pipefd[2];
+    int bulkfd[2];           // pipe dedicado às transferências em massa
+    int bulk_pipe_size;      // capacidade obtida com F_SETPIPE_SZ
+    std::string bulk_sink;   // destino do splice no filho
     pid_t child_pid;
     bool pipe_created;
     bool fork_done;
     bool pipe_open;
+    uint32_t next_sequence;  // sequência da próxima mensagem enviada pelo pai
+    FrameReassembler reassembler;
+    std::vector<PipeWorker> pool;
+    PoolPolicy pool_policy;
+    size_t pool_next;        // próximo filho no round-robin
+    uint64_t pool_start_ns;
+    uint64_t pool_sent;      // mensagens enviadas desde o último relatório
     
-    PipeState() : pipefd{-1, -1}, child_pid(-1), pipe_created(false), 
-                 fork_done(false), pipe_open(false) {}
+    PipeState() : pipefd{-1, -1}, bulkfd{-1, -1}, bulk_pipe_size(0), bulk_sink("/dev/null"),
+                 child_pid(-1), pipe_created(false), fork_done(false), pipe_open(false),
+                 next_sequence(0), pool_policy(POOL_ROUND_ROBIN), pool_next(0),
+                 pool_start_ns(0), pool_sent(0) {}
 };
 
 PipeState pipe_state;
@@ -83,25 +134,215 @@ void createPipe() {
         return;
     }
     
+    if (pipe(pipe_state.bulkfd) == -1) {
+        std::string error_msg = "Erro ao criar pipe de transferência em massa: " + std::string(strerror(errno));
+        logEvent("error", error_msg, "main", getpid());
+        close(pipe_state.pipefd[0]);
+        close(pipe_state.pipefd[1]);
+        return;
+    }
+    
+    // Aumenta a capacidade do pipe de massa (limitado por /proc/sys/fs/pipe-max-size)
+    pipe_state.bulk_pipe_size = fcntl(pipe_state.bulkfd[1], F_SETPIPE_SZ, BULK_PIPE_SIZE);
+    if (pipe_state.bulk_pipe_size == -1) {
+        logEvent("warning", "F_SETPIPE_SZ falhou: " + std::string(strerror(errno)), "main", getpid());
+        pipe_state.bulk_pipe_size = fcntl(pipe_state.bulkfd[1], F_GETPIPE_SZ);
+    }
+    
     pipe_state.pipe_created = true;
     logEvent("pipe", "Pipe criado com sucesso", "main", getpid(), 
              "read_fd=" + std::to_string(pipe_state.pipefd[0]) + 
-             " write_fd=" + std::to_string(pipe_state.pipefd[1]));
+             " write_fd=" + std::to_string(pipe_state.pipefd[1]) +
+             " bulk_pipe_size=" + std::to_string(pipe_state.bulk_pipe_size));
+}
+
+// Função para obter tempo monotônico em nanossegundos
+uint64_t monotonicNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// Formata a vazão em GB/s
+std::string formatGbps(uint64_t bytes, uint64_t elapsed_ns) {
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(3) << (elapsed_ns > 0 ? (double)bytes / elapsed_ns : 0.0);
+    return ss.str();
+}
+
+// Drena o pipe de massa para o destino com splice (sem cópia para espaço de usuário).
+// Retorna false quando o escritor fechou o pipe.
+bool childDrainBulk(int sink_fd, uint64_t& bytes) {
+    while (true) {
+        ssize_t moved = splice(pipe_state.bulkfd[0], NULL, sink_fd, NULL, BULK_CHUNK_SIZE,
+                               SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+        if (moved > 0) {
+            bytes += moved;
+        } else if (moved == 0) {
+            return false;
+        } else if (errno == EAGAIN) {
+            return true;
+        } else {
+            logEvent("error", "Erro no splice do pipe de massa: " + std::string(strerror(errno)), "child", getpid());
+            return false;
+        }
+    }
+}
+
+// Lê até READ_CHUNK_SIZE bytes para o remontador, compactando/crescendo o buffer
+// até MAX_REASSEMBLY_SIZE (cabe a maior mensagem aceita). Com o fluxo corrompido
+// os bytes lidos são descartados
+ssize_t reassemblerRead(FrameReassembler& r, int fd) {
+    if (r.start == r.end || r.corrupted) {
+        r.start = r.end = 0;
+    }
+    if (r.buffer.size() - r.end < READ_CHUNK_SIZE) {
+        if (r.start > 0) {
+            memmove(r.buffer.data(), r.buffer.data() + r.start, r.end - r.start);
+            r.end -= r.start;
+            r.start = 0;
+        }
+        if (r.buffer.size() - r.end < READ_CHUNK_SIZE && r.buffer.size() < MAX_REASSEMBLY_SIZE) {
+            r.buffer.resize(std::min<size_t>(r.end + READ_CHUNK_SIZE, MAX_REASSEMBLY_SIZE));
+        }
+    }
+    
+    // Buffer cheio só ocorre com uma mensagem completa ainda não extraída
+    size_t space = std::min<size_t>(READ_CHUNK_SIZE, r.buffer.size() - r.end);
+    if (space == 0) {
+        errno = ENOBUFS;
+        return -1;
+    }
+    ssize_t n = read(fd, r.buffer.data() + r.end, space);
+    if (n > 0) {
+        r.end += n;
+    }
+    return n;
+}
+
+// Extrai a próxima mensagem completa; retorna false se ainda faltam bytes
+bool reassemblerNext(FrameReassembler& r, FrameHeader& header, std::string& payload) {
+    if (r.corrupted || r.end - r.start < sizeof(FrameHeader)) {
+        return false;
+    }
+    
+    memcpy(&header, r.buffer.data() + r.start, sizeof(FrameHeader));
+    if (header.length > MAX_FRAME_SIZE) {
+        r.corrupted = true;
+        r.start = r.end = 0;
+        logEvent("error", "Cabeçalho de mensagem inválido, descartando o restante do fluxo", "child", getpid(),
+                 "length=" + std::to_string(header.length));
+        return false;
+    }
+    
+    if (r.end - r.start < sizeof(FrameHeader) + header.length) {
+        return false;
+    }
+    
+    payload.assign(r.buffer.data() + r.start + sizeof(FrameHeader), header.length);
+    r.start += sizeof(FrameHeader) + header.length;
+    return true;
+}
+
+// Emite um evento por mensagem completa disponível no remontador
+// (a primeira mensagem de cada chamada é a que acordou o leitor)
+void emitReceivedFrames(FrameReassembler& r) {
+    static WaitSite wake_site("pipe.wake");
+    FrameHeader header;
+    std::string payload;
+    bool first = true;
+    
+    while (reassemblerNext(r, header, payload)) {
+        if (first) {
+            waitRecordWakeup(wake_site, header.sent_ns);
+            first = false;
+        }
+        if (header.sequence != r.expected_sequence) {
+            logEvent("warning", "Sequência de mensagens fora de ordem", "child", getpid(),
+                     "expected=" + std::to_string(r.expected_sequence) +
+                     " received=" + std::to_string(header.sequence));
+        }
+        r.expected_sequence = header.sequence + 1;
+        LOG_EVENT(LOG_INFO, "pipe_read", "Mensagem recebida", "child", getpid(), payload);
+    }
+}
+
+// Fecha a leitura do pipe de massa quando o filho deixa de drená-lo: o pai
+// recebe EPIPE em vez de bloquear para sempre com o pipe cheio
+void childCloseBulk() {
+    if (pipe_state.bulkfd[0] != -1) {
+        close(pipe_state.bulkfd[0]);
+        pipe_state.bulkfd[0] = -1;
+    }
 }
 
 // Loop de leitura dedicado para o processo filho
 void childReadLoop() {
     logEvent("pipe_read", "Filho pronto para ler mensagens do pipe...", "child", getpid());
-    char buffer[256];
+    spanReset();    // histogramas herdados do pai no fork
+    
+    int sink_fd = open(pipe_state.bulk_sink.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (sink_fd == -1) {
+        logEvent("error", "Erro ao abrir destino de massa: " + std::string(strerror(errno)), "child", getpid(),
+                 pipe_state.bulk_sink);
+        childCloseBulk();
+    }
+    
+    // Estatísticas da rajada de massa em andamento
+    uint64_t bulk_bytes = 0;
+    uint64_t bulk_start = 0;
+    uint64_t bulk_last = 0;
+    bool bulk_open = sink_fd != -1;
+    
+    struct pollfd fds[2];
+    fds[0].fd = pipe_state.pipefd[0];
+    fds[0].events = POLLIN;
+    fds[1].fd = bulk_open ? pipe_state.bulkfd[0] : -1;
+    fds[1].events = POLLIN;
 
     // Loop de leitura bloqueante
     while (true) {
-        ssize_t bytes_lidos = read(pipe_state.pipefd[0], buffer, sizeof(buffer) - 1);
+        int timeout = bulk_bytes > 0 ? BULK_IDLE_MS : -1;
+        int ready = waitPoll(fds, 2, timeout);
+        if (ready == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            logEvent("error", "Erro no poll dos pipes: " + std::string(strerror(errno)), "child", getpid());
+            break;
+        }
+        
+        if (fds[1].revents & (POLLIN | POLLHUP)) {
+            uint64_t before = bulk_bytes;
+            if (bulk_bytes == 0) {
+                bulk_start = monotonicNs();
+            }
+            bool still_open = childDrainBulk(sink_fd, bulk_bytes);
+            if (bulk_bytes != before) {
+                bulk_last = monotonicNs();
+            }
+            if (!still_open) {
+                childCloseBulk();
+                fds[1].fd = -1;
+            }
+        }
+        
+        // Rajada encerrada: reporta a vazão observada pelo filho
+        if (bulk_bytes > 0 && (ready == 0 || fds[1].fd == -1)) {
+            logEvent("bulk", "Transferência em massa recebida via splice", "child", getpid(),
+                     "bytes=" + std::to_string(bulk_bytes) + " gbps=" +
+                     formatGbps(bulk_bytes, bulk_last - bulk_start) + " sink=" + pipe_state.bulk_sink);
+            bulk_bytes = 0;
+        }
+        
+        if (!(fds[0].revents & (POLLIN | POLLHUP))) {
+            continue;
+        }
+        
+        ssize_t bytes_lidos = reassemblerRead(pipe_state.reassembler, pipe_state.pipefd[0]);
         
         if (bytes_lidos > 0) {
-            buffer[bytes_lidos] = '\0';
-            std::string received_data(buffer);
-            logEvent("pipe_read", "Mensagem recebida", "child", getpid(), received_data);
+            emitReceivedFrames(pipe_state.reassembler);
         } else if (bytes_lidos == 0) {
             // Fim do arquivo (EOF): o pai fechou a extremidade de escrita.
             logEvent("pipe", "Pipe fechado pelo escritor. Filho encerrando.", "child", getpid());
@@ -112,6 +353,14 @@ void childReadLoop() {
         }
     }
     close(pipe_state.pipefd[0]);
+    childCloseBulk();
+    if (sink_fd != -1) {
+        close(sink_fd);
+    }
+    // O filho não recebe comandos: relata seus spans (latência de acordar) ao sair
+    if (spanRegistry().enabled.load()) {
+        spanReport("pipe_child");
+    }
 }
 
 // Função para fazer fork e criar processos
@@ -138,11 +387,14 @@ void createFork() {
     if (pipe_state.child_pid > 0) { // Processo pai
         logEvent("process", "Processo pai iniciado", "parent", getpid());
         close(pipe_state.pipefd[0]); // Fecha a extremidade de leitura no pai
+        close(pipe_state.bulkfd[0]);
         pipe_state.pipe_open = true;
         
     } else { // Processo filho
         logEvent("process", "Processo filho iniciado", "child", getpid());
+        placementApply(1, "child");
         close(pipe_state.pipefd[1]); // Fecha a extremidade de escrita no filho
+        close(pipe_state.bulkfd[1]);
         pipe_state.pipe_open = true;
 
         // Filho entra em seu próprio loop e não retorna para o main
@@ -151,6 +403,178 @@ void createFork() {
     }
 }
 
+// Função para criar um pool de filhos, cada um lendo do seu próprio pipe
+void createPool(int count) {
+    if (pipe_state.fork_done) {
+        logEvent("warning", "Fork já realizado anteriormente", "main", getpid());
+        return;
+    }
+    
+    if (count < 1 || count > MAX_POOL_SIZE) {
+        logEvent("error", "Tamanho de pool inválido (1-" + std::to_string(MAX_POOL_SIZE) + ")", "main", getpid());
+        return;
+    }
+    
+    for (int i = 0; i < count; i++) {
+        int fd[2];
+        if (pipe(fd) == -1) {
+            logEvent("error", "Erro ao criar pipe do pool: " + std::string(strerror(errno)), "main", getpid());
+            break;
+        }
+        
+        pid_t pid = fork();
+        if (pid < 0) {
+            logEvent("error", "Erro ao criar processo filho: " + std::string(strerror(errno)), "main", getpid());
+            close(fd[0]);
+            close(fd[1]);
+            break;
+        }
+        
+        if (pid == 0) { // Processo filho
+            // Fecha as extremidades de escrita herdadas, senão os outros filhos nunca veem EOF
+            for (size_t j = 0; j < pipe_state.pool.size(); j++) {
+                close(pipe_state.pool[j].write_fd);
+            }
+            close(fd[1]);
+            if (pipe_state.pipe_created) {
+                close(pipe_state.pipefd[0]);
+                close(pipe_state.pipefd[1]);
+                close(pipe_state.bulkfd[0]);
+                close(pipe_state.bulkfd[1]);
+            }
+            
+            pipe_state.pool.clear();
+            pipe_state.pipefd[0] = fd[0];
+            pipe_state.pipefd[1] = -1;
+            pipe_state.bulkfd[0] = -1;   // poll ignora descritores negativos
+            pipe_state.bulkfd[1] = -1;
+            pipe_state.child_pid = 0;
+            pipe_state.pipe_open = true;
+            
+            logEvent("process", "Processo filho do pool iniciado", "child", getpid(), "worker=" + std::to_string(i));
+            placementApply(1 + i, "child");
+            childReadLoop();
+            exit(0);
+        }
+        
+        close(fd[0]);
+        PipeWorker worker;
+        worker.write_fd = fd[1];
+        worker.pid = pid;
+        pipe_state.pool.push_back(worker);
+    }
+    
+    if (pipe_state.pool.empty()) {
+        return;
+    }
+    
+    pipe_state.fork_done = true;
+    pipe_state.pipe_open = true;
+    pipe_state.pool_next = 0;
+    pipe_state.pool_sent = 0;
+    pipe_state.pool_start_ns = monotonicNs();
+    logEvent("process", "Pool de processos filhos criado", "parent", getpid(),
+             "workers=" + std::to_string(pipe_state.pool.size()));
+}
+
+// Escolhe o filho do pool que recebe a mensagem
+PipeWorker& selectWorker(const std::string& message) {
+    std::vector<PipeWorker>& pool = pipe_state.pool;
+    if (pipe_state.pool_policy == POOL_KEY_HASH) {
+        std::string key = message.substr(0, message.find(':'));
+        return pool[std::hash<std::string>()(key) % pool.size()];
+    }
+    PipeWorker& worker = pool[pipe_state.pool_next];
+    pipe_state.pool_next = (pipe_state.pool_next + 1) % pool.size();
+    return worker;
+}
+
+// Função para emitir vazão e profundidade de fila de cada filho do pool
+void reportPoolStats() {
+    if (pipe_state.pool.empty()) {
+        logEvent("error", "Nenhum pool ativo", "parent", getpid());
+        return;
+    }
+    
+    double seconds = (monotonicNs() - pipe_state.pool_start_ns) / 1e9;
+    for (size_t i = 0; i < pipe_state.pool.size(); i++) {
+        const PipeWorker& worker = pipe_state.pool[i];
+        int queued = 0;
+        ioctl(worker.write_fd, FIONREAD, &queued);   // bytes ainda não lidos pelo filho
+        
+        std::stringstream ss;
+        ss << "worker=" << i << " pid=" << worker.pid
+           << " messages=" << worker.messages << " bytes=" << worker.bytes
+           << " msgs_per_sec=" << std::fixed << std::setprecision(1)
+           << (seconds > 0 ? worker.messages / seconds : 0.0)
+           << " queue_bytes=" << queued;
+        logEvent("pool", "Estatísticas do filho do pool", "parent", getpid(), ss.str());
+    }
+    pipe_state.pool_sent = 0;
+}
+
+// Função para configurar a política de distribuição do pool
+void setPoolPolicy(const std::string& policy) {
+    if (policy == "rr") {
+        pipe_state.pool_policy = POOL_ROUND_ROBIN;
+    } else if (policy == "hash") {
+        pipe_state.pool_policy = POOL_KEY_HASH;
+    } else {
+        logEvent("error", "Política desconhecida (use rr ou hash): " + policy, "main", getpid());
+        return;
+    }
+    logEvent("config", "Política do pool configurada", "main", getpid(), policy);
+}
+
+// Contabiliza mensagens enviadas a um filho do pool
+void recordPoolSend(PipeWorker& worker, uint64_t messages, uint64_t bytes) {
+    worker.messages += messages;
+    worker.bytes += bytes;
+    pipe_state.pool_sent += messages;
+    if (pipe_state.pool_sent >= POOL_STATS_INTERVAL) {
+        reportPoolStats();
+    }
+}
+
+// Acrescenta uma mensagem enquadrada ao buffer de um lote
+void appendFrame(std::vector<char>& batch, uint32_t sequence, const std::string& message) {
+    FrameHeader header;
+    header.length = (uint32_t)message.length();
+    header.sequence = sequence;
+    header.sent_ns = monotonicNs();
+    const char* raw = reinterpret_cast<const char*>(&header);
+    batch.insert(batch.end(), raw, raw + sizeof(header));
+    batch.insert(batch.end(), message.begin(), message.end());
+}
+
+// Escreve todos os bytes do vetor, continuando após escritas parciais
+ssize_t writeFully(int fd, struct iovec* iov, int count) {
+    static SpanOp& write_span = spanOp("pipe.write");
+    ssize_t total = 0;
+    while (count > 0) {
+        uint64_t span = spanStart();
+        ssize_t n = writev(fd, iov, count);
+        spanEnd(write_span, span);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        total += n;
+        while (count > 0 && (size_t)n >= iov->iov_len) {
+            n -= iov->iov_len;
+            iov++;
+            count--;
+        }
+        if (count > 0) {
+            iov->iov_base = static_cast<char*>(iov->iov_base) + n;
+            iov->iov_len -= n;
+        }
+    }
+    return total;
+}
+
 // Função para enviar mensagem através do pipe (apenas no pai)
 void sendMessage(const std::string& message) {
     if (!pipe_state.pipe_open) {
@@ -163,17 +587,312 @@ void sendMessage(const std::string& message) {
         return;
     }
     
-    logEvent("pipe_write", "Escrevendo no pipe", "parent", getpid(), message);
+    if (message.length() > MAX_FRAME_SIZE) {
+        logEvent("error", "Mensagem excede o tamanho máximo", "parent", getpid(),
+                 "bytes=" + std::to_string(message.length()));
+        return;
+    }
+    
+    LOG_EVENT(LOG_DEBUG, "pipe_write", "Escrevendo no pipe", "parent", getpid(), message);
     
-    ssize_t bytes_escritos = write(pipe_state.pipefd[1], message.c_str(), message.length());
+    // No modo pool a mensagem vai para o pipe do filho escolhido
+    PipeWorker* worker = pipe_state.pool.empty() ? nullptr : &selectWorker(message);
+    int fd = worker ? worker->write_fd : pipe_state.pipefd[1];
+    uint32_t& sequence = worker ? worker->next_sequence : pipe_state.next_sequence;
+    
+    // Cabeçalho e payload em uma única chamada de sistema
+    FrameHeader header;
+    header.length = (uint32_t)message.length();
+    header.sequence = sequence++;
+    header.sent_ns = monotonicNs();
+    
+    struct iovec iov[2];
+    iov[0].iov_base = &header;
+    iov[0].iov_len = sizeof(header);
+    iov[1].iov_base = const_cast<char*>(message.data());
+    iov[1].iov_len = message.length();
+    
+    ssize_t bytes_escritos = writeFully(fd, iov, 2);
     if (bytes_escritos < 0) {
         logEvent("error", "Erro ao escrever no pipe: " + std::string(strerror(errno)), "parent", getpid());
     } else {
-        logEvent("pipe_write", "Mensagem escrita com sucesso", "parent", getpid(), 
-                 "bytes=" + std::to_string(bytes_escritos));
+        std::string details = "bytes=" + std::to_string(bytes_escritos);
+        if (worker) {
+            details += " worker=" + std::to_string(worker - pipe_state.pool.data());
+        }
+        LOG_EVENT(LOG_INFO, "pipe_write", "Mensagem escrita com sucesso", "parent", getpid(), details);
+        if (worker) {
+            recordPoolSend(*worker, 1, message.length());
+        }
+    }
+}
+
+// Função para enviar n mensagens enquadradas em uma única escrita
+void sendBatch(int count, const std::string& message) {
+    if (!pipe_state.pipe_open) {
+        logEvent("error", "Pipe não está aberto", "parent", getpid());
+        return;
+    }
+    
+    if (pipe_state.child_pid == 0) {
+        logEvent("error", "Esta função só pode ser chamada pelo processo pai", "child", getpid());
+        return;
+    }
+    
+    if (message.length() > MAX_FRAME_SIZE) {
+        logEvent("error", "Mensagem excede o tamanho máximo", "parent", getpid(),
+                 "bytes=" + std::to_string(message.length()));
+        return;
+    }
+    
+    // Um buffer por destino: o pipe único ou cada filho do pool
+    size_t targets = pipe_state.pool.empty() ? 1 : pipe_state.pool.size();
+    std::vector<std::vector<char> > batches(targets);
+    std::vector<uint64_t> counts(targets, 0);
+    for (int i = 0; i < count; i++) {
+        if (pipe_state.pool.empty()) {
+            appendFrame(batches[0], pipe_state.next_sequence++, message);
+            counts[0]++;
+        } else {
+            PipeWorker& worker = selectWorker(message);
+            size_t index = &worker - pipe_state.pool.data();
+            appendFrame(batches[index], worker.next_sequence++, message);
+            counts[index]++;
+        }
+    }
+    
+    uint64_t start = monotonicNs();
+    ssize_t total = 0;
+    for (size_t t = 0; t < targets && total >= 0; t++) {
+        if (batches[t].empty()) {
+            continue;
+        }
+        struct iovec iov;
+        iov.iov_base = batches[t].data();
+        iov.iov_len = batches[t].size();
+        int fd = pipe_state.pool.empty() ? pipe_state.pipefd[1] : pipe_state.pool[t].write_fd;
+        ssize_t n = writeFully(fd, &iov, 1);
+        if (n < 0) {
+            total = -1;
+        } else {
+            total += n;
+            if (!pipe_state.pool.empty()) {
+                recordPoolSend(pipe_state.pool[t], counts[t], counts[t] * message.length());
+            }
+        }
+    }
+    uint64_t elapsed = monotonicNs() - start;
+    
+    if (total < 0) {
+        logEvent("error", "Erro ao escrever no pipe: " + std::string(strerror(errno)), "parent", getpid());
+    } else {
+        logEvent("pipe_write", "Lote de mensagens escrito com sucesso", "parent", getpid(),
+                 "messages=" + std::to_string(count) + " bytes=" + std::to_string(total) +
+                 " writes=" + std::to_string(targets) +
+                 " elapsed_us=" + std::to_string(elapsed / 1000));
     }
 }
 
+// Verifica se o pai pode usar o pipe de massa
+bool bulkReady() {
+    if (!pipe_state.pipe_open) {
+        logEvent("error", "Pipe não está aberto", "parent", getpid());
+        return false;
+    }
+    
+    // O pool fecha o pipe de massa: cada filho só tem o próprio pipe de mensagens
+    if (!pipe_state.pool.empty()) {
+        logEvent("error", "Transferência em massa não suportada no modo pool", "parent", getpid(),
+                 "workers=" + std::to_string(pipe_state.pool.size()));
+        return false;
+    }
+    
+    if (pipe_state.child_pid <= 0) {
+        logEvent("error", "Transferência em massa só pode ser feita pelo processo pai", "main", getpid());
+        return false;
+    }
+    return true;
+}
+
+// Escreve total bytes do buffer com write() (caminho com cópia, para comparação)
+bool bulkWritePlain(const char* buffer, size_t chunk, uint64_t total) {
+    uint64_t remaining = total;
+    while (remaining > 0) {
+        ssize_t n = write(pipe_state.bulkfd[1], buffer, std::min<uint64_t>(chunk, remaining));
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            logEvent("error", "Erro no write do pipe de massa: " + std::string(strerror(errno)), "parent", getpid());
+            return false;
+        }
+        remaining -= n;
+    }
+    return true;
+}
+
+// Função para enviar bytes gerados em memória via vmsplice e comparar com write()
+// Aguarda o filho consumir tudo que está no pipe de massa (FIONREAD == 0), para
+// que a vazão medida inclua a entrega ao consumidor. Retorna false no timeout
+bool bulkWaitDrained() {
+    uint64_t deadline = monotonicNs() + BULK_DRAIN_TIMEOUT_MS * 1000000ULL;
+    int queued = 0;
+    while (ioctl(pipe_state.bulkfd[1], FIONREAD, &queued) == 0 && queued > 0) {
+        // POLLERR na escrita: o filho fechou a leitura e nunca vai drenar o pipe
+        struct pollfd pfd = {pipe_state.bulkfd[1], POLLOUT, 0};
+        if (poll(&pfd, 1, 0) == 1 && (pfd.revents & POLLERR)) {
+            logEvent("error", "Filho fechou o pipe de massa sem drená-lo", "parent", getpid(),
+                     "queued=" + std::to_string(queued));
+            return false;
+        }
+        if (monotonicNs() >= deadline) {
+            logEvent("error", "Filho não esvaziou o pipe de massa a tempo", "parent", getpid(),
+                     "queued=" + std::to_string(queued));
+            return false;
+        }
+        usleep(BULK_DRAIN_POLL_US);
+    }
+    return true;
+}
+
+// Buffer de origem do vmsplice. Sem SPLICE_F_GIFT o pipe referencia as próprias
+// páginas do buffer até o filho consumi-las, por isso ele é alocado e preenchido
+// uma única vez e nunca é liberado nem alterado
+char* bulkSourceBuffer() {
+    static char* buffer = nullptr;
+    if (!buffer) {
+        void* memory = nullptr;
+        if (posix_memalign(&memory, PAGE_SIZE_BYTES, BULK_CHUNK_SIZE) != 0) {
+            return nullptr;
+        }
+        buffer = static_cast<char*>(memory);
+        for (size_t i = 0; i < BULK_CHUNK_SIZE; i++) {
+            buffer[i] = (char)('a' + i % 26);
+        }
+    }
+    return buffer;
+}
+
+void sendBulk(uint64_t total) {
+    if (!bulkReady()) {
+        return;
+    }
+    
+    // vmsplice exige páginas alinhadas
+    char* buffer = bulkSourceBuffer();
+    if (!buffer) {
+        logEvent("error", "Erro ao alocar buffer alinhado", "parent", getpid());
+        return;
+    }
+    
+    logEvent("bulk", "Iniciando transferência em massa via vmsplice", "parent", getpid(),
+             "bytes=" + std::to_string(total));
+    
+    uint64_t start = monotonicNs();
+    uint64_t remaining = total;
+    bool ok = true;
+    while (remaining > 0) {
+        struct iovec iov;
+        iov.iov_base = buffer;
+        iov.iov_len = std::min<uint64_t>(BULK_CHUNK_SIZE, remaining);
+        ssize_t n = vmsplice(pipe_state.bulkfd[1], &iov, 1, 0);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            logEvent("error", "Erro no vmsplice: " + std::string(strerror(errno)), "parent", getpid());
+            ok = false;
+            break;
+        }
+        remaining -= n;
+    }
+    // As vazões contam até o filho drenar o pipe, não só até as páginas entrarem na fila
+    ok = ok && bulkWaitDrained();
+    uint64_t vmsplice_ns = monotonicNs() - start;
+    
+    // Mesmo volume pelo caminho tradicional com write()
+    start = monotonicNs();
+    ok = ok && bulkWritePlain(buffer, BULK_CHUNK_SIZE, total) && bulkWaitDrained();
+    uint64_t write_ns = monotonicNs() - start;
+    
+    if (ok) {
+        logEvent("bulk", "Transferência em massa concluída", "parent", getpid(),
+                 "bytes=" + std::to_string(total) +
+                 " vmsplice_gbps=" + formatGbps(total, vmsplice_ns) +
+                 " write_gbps=" + formatGbps(total, write_ns) +
+                 " pipe_size=" + std::to_string(pipe_state.bulk_pipe_size));
+    }
+}
+
+// Função para enviar um arquivo via splice (page cache -> pipe) e comparar com read()/write()
+void sendFile(const std::string& path) {
+    if (!bulkReady()) {
+        return;
+    }
+    
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd == -1) {
+        logEvent("error", "Erro ao abrir arquivo: " + std::string(strerror(errno)), "parent", getpid(), path);
+        return;
+    }
+    
+    logEvent("bulk", "Iniciando envio de arquivo via splice", "parent", getpid(), path);
+    
+    uint64_t start = monotonicNs();
+    uint64_t total = 0;
+    bool ok = true;
+    while (true) {
+        ssize_t n = splice(fd, NULL, pipe_state.bulkfd[1], NULL, BULK_CHUNK_SIZE, SPLICE_F_MOVE | SPLICE_F_MORE);
+        if (n == 0) {
+            break;
+        }
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            logEvent("error", "Erro no splice do arquivo: " + std::string(strerror(errno)), "parent", getpid());
+            ok = false;
+            break;
+        }
+        total += n;
+    }
+    ok = ok && bulkWaitDrained();
+    uint64_t splice_ns = monotonicNs() - start;
+    
+    // Mesmo arquivo pelo caminho tradicional read() + write()
+    std::vector<char> buffer(BULK_CHUNK_SIZE);
+    uint64_t write_ns = 0;
+    if (ok && lseek(fd, 0, SEEK_SET) == 0) {
+        start = monotonicNs();
+        ssize_t n;
+        while (ok && (n = read(fd, buffer.data(), buffer.size())) > 0) {
+            ok = bulkWritePlain(buffer.data(), buffer.size(), n);
+        }
+        ok = ok && bulkWaitDrained();
+        write_ns = monotonicNs() - start;
+    }
+    close(fd);
+    
+    if (ok) {
+        logEvent("bulk", "Envio de arquivo concluído", "parent", getpid(),
+                 "bytes=" + std::to_string(total) +
+                 " splice_gbps=" + formatGbps(total, splice_ns) +
+                 " write_gbps=" + formatGbps(total, write_ns) +
+                 " pipe_size=" + std::to_string(pipe_state.bulk_pipe_size));
+    }
+}
+
+// Função para configurar o destino do splice no filho (antes do fork)
+void setBulkSink(const std::string& path) {
+    if (pipe_state.fork_done) {
+        logEvent("error", "O destino deve ser configurado antes do fork", "main", getpid());
+        return;
+    }
+    
+    pipe_state.bulk_sink = path;
+    logEvent("config", "Destino da transferência em massa configurado", "main", getpid(), path);
+}
+
 // Função para ler mensagens do pipe (apenas no filho)
 void readMessages() {
     if (!pipe_state.pipe_open) {
@@ -192,32 +911,30 @@ void readMessages() {
     int flags = fcntl(pipe_state.pipefd[0], F_GETFL, 0);
     fcntl(pipe_state.pipefd[0], F_SETFL, flags | O_NONBLOCK);
     
-    char buffer[256];
     bool data_available = true;
+    struct pollfd pfd;
+    pfd.fd = pipe_state.pipefd[0];
+    pfd.events = POLLIN;
     
     while (data_available && pipe_state.pipe_open) {
-        ssize_t bytes_lidos = read(pipe_state.pipefd[0], buffer, sizeof(buffer) - 1);
+        ssize_t bytes_lidos = reassemblerRead(pipe_state.reassembler, pipe_state.pipefd[0]);
         
         if (bytes_lidos > 0) {
-            buffer[bytes_lidos] = '\0';
-            std::string received_data(buffer);
-            logEvent("pipe_read", "Mensagem recebida", "child", getpid(), received_data);
+            emitReceivedFrames(pipe_state.reassembler);
         } 
         else if (bytes_lidos == 0) {
             logEvent("pipe", "Pipe fechado pelo escritor", "child", getpid());
             data_available = false;
         }
         else if (errno == EAGAIN || errno == EWOULDBLOCK) {
-            // Não há dados disponíveis no momento
-            data_available = false;
+            // Sem dados no momento: espera (com a estratégia configurada) por até
+            // READ_IDLE_MS em vez de dormir um intervalo fixo a cada leitura
+            data_available = waitPoll(&pfd, 1, READ_IDLE_MS) > 0;
         }
         else {
             logEvent("error", "Erro na leitura do pipe: " + std::string(strerror(errno)), "child", getpid());
             data_available = false;
         }
-        
-        // Pequena pausa para evitar loop muito rápido
-        usleep(100000); // 100ms
     }
 }
 
@@ -228,9 +945,30 @@ void closePipe() {
         return;
     }
     
-    if (pipe_state.child_pid > 0) { // Processo pai
+    if (!pipe_state.pool.empty()) { // Pai com pool: fecha todos os pipes e reaproveita todos os filhos
+        logEvent("pipe", "Fechando pipes do pool", "parent", getpid());
+        for (size_t i = 0; i < pipe_state.pool.size(); i++) {
+            close(pipe_state.pool[i].write_fd);
+        }
+        if (pipe_state.pipe_created) {
+            close(pipe_state.pipefd[0]);
+            close(pipe_state.pipefd[1]);
+            close(pipe_state.bulkfd[0]);
+            close(pipe_state.bulkfd[1]);
+        }
+        
+        logEvent("process", "Aguardando término dos filhos do pool", "parent", getpid());
+        for (size_t i = 0; i < pipe_state.pool.size(); i++) {
+            waitpid(pipe_state.pool[i].pid, NULL, 0);
+        }
+        logEvent("process", "Processos filhos do pool finalizados", "parent", getpid(),
+                 "workers=" + std::to_string(pipe_state.pool.size()));
+        pipe_state.pool.clear();
+        
+    } else if (pipe_state.child_pid > 0) { // Processo pai
         logEvent("pipe", "Fechando extremidade de escrita", "parent", getpid());
         close(pipe_state.pipefd[1]);
+        close(pipe_state.bulkfd[1]);
         
         logEvent("process", "Aguardando término do filho", "parent", getpid());
         waitpid(pipe_state.child_pid, NULL, 0);
@@ -254,59 +992,119 @@ void resetPipe() {
     // Resetar o estado
     pipe_state.pipefd[0] = -1;
     pipe_state.pipefd[1] = -1;
+    pipe_state.bulkfd[0] = -1;
+    pipe_state.bulkfd[1] = -1;
     pipe_state.child_pid = -1;
+    pipe_state.next_sequence = 0;
+    pipe_state.reassembler = FrameReassembler();
+    pipe_state.pool.clear();
     pipe_state.pipe_created = false;
     pipe_state.fork_done = false;
     
     logEvent("system", "Estado do pipe resetado", "main", getpid());
 }
 
-// Função principal com controle por comandos
-int main() {
-    logEvent("system", "Pipe Monitor iniciado - Aguardando comandos", "main", getpid());
-    logEvent("instruction", "Comandos disponíveis: create_pipe, create_fork, send <message>, read, close_pipe, reset, exit", "main", getpid());
-    
-    std::string command;
-    
-    while (true) {
-        // Ler comando do stdin
-        if (!std::getline(std::cin, command)) {
-            break;
-        }
-        
-        // Processar comando
-        if (command == "create_pipe") {
-            createPipe();
-        }
-        else if (command == "create_fork") {
-            createFork();
-        }
-        else if (command.find("send ") == 0) {
-            if (command.length() > 5) {
-                std::string message = command.substr(5);
-                sendMessage(message);
-            } else {
-                logEvent("error", "Comando send requer uma mensagem", "main", getpid());
-            }
-        }
-        else if (command == "close_pipe") {
-            closePipe();
-            break; // Adicionado para encerrar o loop principal após fechar o pipe
-        }
-        else if (command == "reset") {
-            resetPipe();
+// Função para relatar eventos do loop de comandos (batch, repeat)
+void reportCommand(const std::string& type, const std::string& message, const std::string& data) {
+    logEvent(type, message, "main", getpid(), data);
+}
+
+// Função para executar um comando; false encerra o programa
+bool handleCommand(const std::string& command) {
+    if (command == "create_pipe") {
+        createPipe();
+    }
+    else if (command == "create_fork") {
+        createFork();
+    }
+    else if (command.find("create_pool ") == 0) {
+        createPool(atoi(command.substr(12).c_str()));
+    }
+    else if (command.find("pool_policy ") == 0) {
+        setPoolPolicy(command.substr(12));
+    }
+    else if (command == "pool_stats") {
+        reportPoolStats();
+    }
+    else if (command.find("send ") == 0) {
+        if (command.length() > 5) {
+            std::string message = command.substr(5);
+            sendMessage(message);
+        } else {
+            logEvent("error", "Comando send requer uma mensagem", "main", getpid());
         }
-        else if (command == "exit") {
-            logEvent("system", "Encerrando Pipe Monitor", "main", getpid());
-            break;
+    }
+    else if (command.find("send_batch ") == 0) {
+        std::istringstream args(command.substr(11));
+        int count = 0;
+        std::string message;
+        args >> count;
+        std::getline(args >> std::ws, message);
+        if (count > 0 && !message.empty()) {
+            sendBatch(count, message);
+        } else {
+            logEvent("error", "Comando send_batch requer quantidade e mensagem", "main", getpid());
         }
-        else if (!command.empty()) {
-            logEvent("error", "Comando não reconhecido: " + command, "main", getpid());
+    }
+    else if (command.find("send_bulk ") == 0) {
+        unsigned long long bytes = strtoull(command.substr(10).c_str(), nullptr, 10);
+        if (bytes > 0) {
+            sendBulk(bytes);
+        } else {
+            logEvent("error", "Comando send_bulk requer um número de bytes", "main", getpid());
         }
-        
-        // Pequena pausa para evitar consumo excessivo de CPU
-        usleep(10000); // 10ms
     }
+    else if (command.find("send_file ") == 0) {
+        sendFile(command.substr(10));
+    }
+    else if (command.find("bulk_sink ") == 0) {
+        setBulkSink(command.substr(10));
+    }
+    else if (command == "close_pipe") {
+        closePipe();
+        return false; // Encerra o programa após fechar o pipe
+    }
+    else if (command == "reset") {
+        resetPipe();
+    }
+    else if (command == "loglevel" || command.find("loglevel ") == 0) {
+        logLevelCommand(command.substr(8));
+    }
+    else if (command == "topology") {
+        placementTopologyCommand("pipe_monitor");
+    }
+    else if (command == "stats" || command.find("stats ") == 0) {
+        spanCommand(command.substr(5), "pipe_monitor");
+    }
+    else if (command == "wait" || command.find("wait ") == 0) {
+        waitCommand(command.substr(4), "pipe_monitor");
+    }
+    else if (command == "exit") {
+        logEvent("system", "Encerrando Pipe Monitor", "main", getpid());
+        return false;
+    }
+    else if (!command.empty()) {
+        logEvent("error", "Comando não reconhecido: " + command, "main", getpid());
+    }
+    return true;
+}
+
+// Função principal com controle por comandos
+int main(int argc, char* argv[]) {
+    logInit(argc, argv);
+    CommandRunner runner(handleCommand, reportCommand);
+    commandInit(argc, argv, runner);
+    spanInit(argc, argv);
+    placementInit(argc, argv, "main");
+    waitInit(argc, argv);
+    
+    // Escritas em pipes cujo leitor saiu devem falhar com EPIPE, não encerrar o monitor
+    signal(SIGPIPE, SIG_IGN);
+    
+    logEvent("system", "Pipe Monitor iniciado - Aguardando comandos", "main", getpid(), placementSummary());
+    logEvent("instruction", "Comandos disponíveis: create_pipe, create_fork, create_pool <n>, pool_policy <rr|hash>, pool_stats, send <message>, send_batch <n> <message>, send_bulk <bytes>, send_file <path>, bulk_sink <path>, read, close_pipe, reset, batch <arquivo>, repeat <n> <comando>, stats [on|off|reset], wait [block|spin|spin_yield|adaptive] [spin_us], topology, loglevel [categoria] [nível|sample <n>], exit", "main", getpid());
+    
+    runCommandLoop(runner);
     
     // Limpeza final se necessário
     if (pipe_state.pipe_open) {
@@ -9,12 +9,56 @@
 #include <sstream>
 #include <iomanip>
 #include <string>
+#include <algorithm>
 #include <cerrno>
 #include <fcntl.h>
+#include <atomic>
+#include <cstdint>
+#include <climits>
+#include <cstdlib>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <csignal>
+#include <sched.h>
+#include <pthread.h>
+#include "log.h"
+#include "commands.h"
+#include "spans.h"
+#include "placement.h"
+#include "wait.h"
 
 #define SHM_KEY 0x1234
 #define SEM_KEY 0x5678
-#define SHM_SIZE 1024
+
+// Configuração do ring buffer SPSC (número de slots deve ser potência de dois)
+#define CACHE_LINE_SIZE 64
+#define RING_SLOTS 1024
+#define RING_SLOT_SIZE 256
+
+// Configuração do alocador de mensagens de tamanho variável (slab por classes)
+#define SLAB_ARENA_SIZE (256 * 1024)
+#define SLAB_MIN_BLOCK 32                       // menor bloco (classe 0), também o alinhamento
+#define SLAB_CLASS_COUNT 11                     // blocos de 32 B a 32 KiB
+#define SLAB_BLOCK_MAGIC 0x534C4142             // "SLAB"
+
+// Configuração do log compartilhado MPMC (cada leitor com seu próprio cursor)
+#define BCAST_SLOTS 1024
+#define BCAST_SLOT_SIZE 256
+#define BCAST_MAX_READERS 16
+#define BCAST_LAG_WARN (BCAST_SLOTS * 3 / 4)     // atraso a partir do qual o leitor é relatado
+#define BCAST_WRITER_TIMEOUT_NS 100000000ULL    // espera por um slot não publicado antes de checar o escritor
+
+// Configuração do snapshot em buffers triplos (segmento POSIX "<nome>.snap")
+#define SNAP_BUFFERS 3
+#define SNAP_MAGIC 0x50414E53                   // "SNAP"
+#define SNAP_INITIAL_CAPACITY (1024 * 1024)     // capacidade inicial de cada buffer
+#define SNAP_WAIT_NS 1000000000ULL              // espera máxima por um buffer livre
+
+static_assert((RING_SLOTS & (RING_SLOTS - 1)) == 0, "RING_SLOTS deve ser potência de dois");
+static_assert((BCAST_SLOTS & (BCAST_SLOTS - 1)) == 0, "BCAST_SLOTS deve ser potência de dois");
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "Ring buffer requer atômicos de 64 bits lock-free");
 
 // Estrutura dos dados compartilhados
 struct SharedData {
@@ -23,116 +67,762 @@ struct SharedData {
     bool updated;
     pid_t last_writer;
     time_t last_update;
+    uint64_t length;        // tamanho completo da última mensagem (pode exceder message)
+    uint32_t checksum;      // FNV-1a dos campos acima exceto updated, validado na recuperação
 };
 
-// Definição necessária para semctl
-union semun {
-    int val;
-    struct semid_ds *buf;
-    unsigned short *array;
+// Slot de tamanho fixo do ring buffer
+struct RingSlot {
+    uint32_t length;
+    char data[RING_SLOT_SIZE - sizeof(uint32_t)];
+};
+
+// Ring buffer SPSC: tail é avançado apenas pelo produtor e head apenas pelo
+// consumidor, cada um em sua própria linha de cache para evitar false sharing
+struct RingBuffer {
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> tail;   // próxima posição a escrever
+    std::atomic<uint64_t> drops;                           // mensagens descartadas (anel cheio)
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> head;   // próxima posição a ler
+    alignas(CACHE_LINE_SIZE) RingSlot slots[RING_SLOTS];
+};
+
+// Slot do log compartilhado: sequence vale posição + 1 depois de publicado
+struct BroadcastSlot {
+    std::atomic<uint64_t> sequence;
+    std::atomic<uint64_t> claimed;      // posição cujo escritor assumiu o slot (writer)
+    uint32_t length;
+    pid_t writer;
+    char data[BCAST_SLOT_SIZE - 2 * sizeof(uint64_t) - sizeof(uint32_t) - sizeof(pid_t)];
+};
+
+// Entrada da tabela de leitores, uma linha de cache por leitor
+struct BroadcastReader {
+    alignas(CACHE_LINE_SIZE) std::atomic<int> pid;   // 0 livre, -1 entrando, >0 leitor ativo
+    std::atomic<int> lagging;                       // 1 enquanto atrasado (já relatado)
+    std::atomic<uint64_t> cursor;                   // próxima posição a ler
+    std::atomic<uint64_t> received;                 // mensagens lidas por este leitor
+};
+
+// Log limitado multiprodutor/multiconsumidor: escritores reservam posições com
+// CAS em reserve e nunca reutilizam um slot que algum leitor ativo ainda não leu
+struct BroadcastLog {
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> reserve;   // próxima posição a reservar
+    std::atomic<uint64_t> rejected;                          // escritas recusadas (log cheio)
+    BroadcastReader readers[BCAST_MAX_READERS];
+    alignas(CACHE_LINE_SIZE) BroadcastSlot slots[BCAST_SLOTS];
+};
+
+// Cabeçalho de cada bloco do slab; offsets são relativos ao início da arena
+// para funcionar em qualquer endereço de mapeamento
+struct SlabBlockHeader {
+    uint32_t magic;
+    uint16_t size_class;
+    uint16_t allocated;
+    uint32_t length;        // bytes de mensagem armazenados
+    uint32_t next_free;     // próximo bloco livre da mesma classe (0 = fim da lista)
+};
+
+// Arena com listas livres por classe de tamanho (protegida pelo lock do segmento).
+// O offset 0 é reservado para representar "nulo" nas listas livres.
+struct SlabArena {
+    uint32_t bump;                              // início da área nunca alocada
+    uint32_t free_head[SLAB_CLASS_COUNT];       // topo da lista livre de cada classe
+    uint32_t free_count[SLAB_CLASS_COUNT];      // blocos em cada lista livre
+    uint64_t live_blocks;
+    uint64_t live_block_bytes;                  // bytes de blocos em uso (com cabeçalho)
+    uint64_t live_requested_bytes;              // bytes de mensagem em uso
+    alignas(CACHE_LINE_SIZE) char storage[SLAB_ARENA_SIZE];
+};
+
+// Modos de exclusão mútua do segmento
+enum LockMode {
+    LOCK_FUTEX = 0,   // lock em espaço de usuário, só entra no kernel com disputa
+    LOCK_SYSV = 1,    // semáforo System V (semop a cada lock/unlock)
+    LOCK_ROBUST = 2   // pthread mutex robusto: a morte do dono é detectada (EOWNERDEAD)
+};
+
+// Palavras de sincronização compartilhadas (futex)
+struct SegmentSync {
+    alignas(CACHE_LINE_SIZE) std::atomic<int> lock_word;   // 0 livre, 1 ocupado, 2 ocupado com espera
+    std::atomic<int> lock_mode;                           // LockMode em uso por todos os processos
+    std::atomic<int> data_seq;                            // incrementado a cada escrita ("dados disponíveis")
+    std::atomic<int> data_waiters;                        // leitores bloqueados em data_seq
+    std::atomic<uint64_t> data_ns;                        // CLOCK_MONOTONIC da última escrita (latência de acordar)
+    alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> seqlock; // ímpar durante escrita em SharedData
+    alignas(CACHE_LINE_SIZE) std::atomic<int> init_state;  // mutex robusto: 0 novo, 1 inicializando, 2 pronto
+    std::atomic<int> lock_owner;                          // pid do dono atual nos modos robust e sysv (0 = livre)
+    std::atomic<uint32_t> recoveries;                     // recuperações após morte do dono
+    pthread_mutex_t robust_mutex;
+};
+
+static_assert(sizeof(std::atomic<int>) == sizeof(int), "futex requer std::atomic<int> do tamanho de int");
+
+// Nome do modo de lock para eventos e estado
+const char* lockModeName(int mode) {
+    switch (mode) {
+        case LOCK_SYSV: return "sysv";
+        case LOCK_ROBUST: return "robust";
+        default: return "futex";
+    }
+}
+
+// Layout do segmento compartilhado
+struct SharedSegment {
+    SharedData data;
+    SegmentSync sync;
+    RingBuffer ring;
+    SlabArena arena;
+    BroadcastLog broadcast;
 };
 
-// Função para obter timestamp
-std::string getTimestamp() {
-    std::time_t now = std::time(nullptr);
-    std::tm* tm = std::localtime(&now);
+#define SHM_SIZE sizeof(SharedSegment)
+#define DEFAULT_POSIX_NAME "/ipc_demo_shm"
+#define HUGE_PAGE_SIZE (2UL * 1024 * 1024)
+
+// Descritor de um buffer do snapshot; offset e capacidade mudam quando o
+// buffer é realocado no fim do segmento para caber um blob maior
+struct SnapshotBuffer {
+    alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> readers;   // leitores com o buffer fixado
+    pid_t writer;
+    uint64_t offset;            // início dos dados, relativo ao início do segmento
+    uint64_t capacity;
+    uint64_t length;
+    uint64_t generation;        // publicação que o buffer contém (0 = vazio)
+    uint64_t published_ns;
+    uint64_t checksum;
+};
+
+// Cabeçalho do segmento de snapshot: o escritor preenche um buffer inativo e
+// troca published; leitores fixam o publicado e nunca esperam pelo escritor
+struct SnapshotHeader {
+    uint32_t magic;
+    std::atomic<int> init_state;                 // 0 novo, 1 inicializando, 2 pronto
+    std::atomic<int> writer_pid;                 // escritor atual (0 = nenhum)
+    std::atomic<uint64_t> size;                  // tamanho do segmento (só cresce)
+    std::atomic<uint64_t> pinned_waits;          // publicações que esperaram por buffer fixado
+    alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> published;   // buffer mais recente
+    std::atomic<uint64_t> generation;
+    SnapshotBuffer buffers[SNAP_BUFFERS];
+};
+
+// Mapeamento local do segmento de snapshot (remapeado quando ele cresce)
+struct SnapshotMapping {
+    int fd;
+    char* base;
+    size_t mapped;
     
-    std::stringstream ss;
-    ss << std::put_time(tm, "%Y-%m-%d %H:%M:%S");
-    return ss.str();
+    SnapshotMapping() : fd(-1), base(nullptr), mapped(0) {}
+};
+
+SnapshotMapping snapshot_map;
+
+// Backends de memória compartilhada
+enum ShmBackend {
+    BACKEND_SYSV,    // shmget/shmat com chave fixa
+    BACKEND_POSIX    // shm_open/ftruncate/mmap com nome e tamanho configuráveis
+};
+
+// Configuração do segmento escolhida na linha de comando
+struct SegmentConfig {
+    ShmBackend backend;
+    std::string name;       // nome POSIX (ex.: /ipc_demo_shm)
+    size_t size;            // tamanho solicitado em bytes
+    size_t mapped_size;     // tamanho efetivamente mapeado
+    bool hugetlb;           // tentar páginas enormes (MAP_HUGETLB/SHM_HUGETLB)
+    bool populate;          // pré-faltar páginas (MAP_POPULATE)
+    bool huge_pages_active; // páginas enormes obtidas de fato
+    
+    SegmentConfig() : backend(BACKEND_SYSV), name(DEFAULT_POSIX_NAME), size(SHM_SIZE),
+                     mapped_size(0), hugetlb(false), populate(false), huge_pages_active(false) {}
+};
+
+SegmentConfig segment_config;
+
+// Área de payload após o cabeçalho: mensagens maiores que SharedData::message
+char* payloadArea(SharedSegment* segment) {
+    return reinterpret_cast<char*>(segment) + sizeof(SharedSegment);
 }
 
-// Função para escapar strings JSON
-std::string escapeJson(const std::string& str) {
-    std::string result;
-    for (char c : str) {
-        switch (c) {
-            case '"': result += "\\\""; break;
-            case '\\': result += "\\\\"; break;
-            case '\b': result += "\\b"; break;
-            case '\f': result += "\\f"; break;
-            case '\n': result += "\\n"; break;
-            case '\r': result += "\\r"; break;
-            case '\t': result += "\\t"; break;
-            default: result += c; break;
-        }
+size_t payloadCapacity() {
+    return segment_config.mapped_size > SHM_SIZE ? segment_config.mapped_size - SHM_SIZE : 0;
+}
+
+// Mensagem completa armazenada (do payload quando excede o campo fixo)
+std::string storedMessage(SharedSegment* segment) {
+    const SharedData& data = segment->data;
+    if (data.length >= sizeof(data.message) && payloadCapacity() > 0) {
+        return std::string(payloadArea(segment), std::min<uint64_t>(data.length, payloadCapacity()));
     }
-    return result;
+    return std::string(data.message);
 }
 
+// Definição necessária para semctl
+union semun {
+    int val;
+    struct semid_ds *buf;
+    unsigned short *array;
+};
+
 // Função para log JSON
 void logEvent(const std::string& type, const std::string& message, 
               const std::string& process = "", pid_t pid = 0, 
               const std::string& data = "") {
-    
-    std::cout << "{";
-    std::cout << "\"timestamp\": \"" << getTimestamp() << "\",";
-    std::cout << "\"type\": \"" << type << "\",";
-    std::cout << "\"process\": \"" << process << "\",";
-    std::cout << "\"pid\": " << pid << ",";
-    std::cout << "\"message\": \"" << escapeJson(message) << "\"";
-    
+    if (!logAccept(type)) {
+        return;
+    }
+    LogLine& line = logBegin(type);
+    logString(line, "process", process);
+    logInt(line, "pid", pid);
+    logString(line, "message", message);
     if (!data.empty()) {
-        std::cout << ",\"data\": \"" << escapeJson(data) << "\"";
+        logString(line, "data", data);
+    }
+    logEnd(line);
+}
+
+// Função para obter tempo monotônico em nanossegundos
+uint64_t monotonicNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// Amostra local da vazão do ring buffer, recalculada a cada janela de 1s
+struct RingRateSample {
+    uint64_t ns;
+    uint64_t tail;
+    uint64_t head;
+    double write_rate;
+    double read_rate;
+
+    RingRateSample() : ns(0), tail(0), head(0), write_rate(0), read_rate(0) {}
+};
+
+RingRateSample ring_rate;
+
+void updateRingRates(RingBuffer* ring) {
+    uint64_t now = monotonicNs();
+    uint64_t tail = ring->tail.load(std::memory_order_acquire);
+    uint64_t head = ring->head.load(std::memory_order_acquire);
+
+    if (ring_rate.ns == 0) {
+        ring_rate.ns = now;
+        ring_rate.tail = tail;
+        ring_rate.head = head;
+        return;
+    }
+
+    uint64_t elapsed = now - ring_rate.ns;
+    if (elapsed >= 1000000000ULL) {
+        double seconds = elapsed / 1e9;
+        ring_rate.write_rate = (tail - ring_rate.tail) / seconds;
+        ring_rate.read_rate = (head - ring_rate.head) / seconds;
+        ring_rate.ns = now;
+        ring_rate.tail = tail;
+        ring_rate.head = head;
+    }
+}
+
+// Tamanho do bloco de uma classe do slab
+uint32_t slabClassSize(int size_class) {
+    return SLAB_MIN_BLOCK << size_class;
+}
+
+// Função para exibir estatísticas do alocador em JSON (sem lock: valores aproximados)
+void displayArenaState(std::ostream& out, SlabArena* arena) {
+    uint64_t free_list_bytes = 0;
+    uint64_t largest_free = 0;
+    for (int c = 0; c < SLAB_CLASS_COUNT; c++) {
+        free_list_bytes += (uint64_t)arena->free_count[c] * slabClassSize(c);
+        if (arena->free_count[c] > 0) {
+            largest_free = std::max<uint64_t>(largest_free, slabClassSize(c));
+        }
     }
     
-    std::cout << "}" << std::endl;
-    std::cout.flush();
+    uint32_t bump = arena->bump == 0 ? SLAB_MIN_BLOCK : arena->bump;
+    uint64_t untouched = SLAB_ARENA_SIZE - bump;
+    uint64_t free_bytes = untouched + free_list_bytes;
+    largest_free = std::max(largest_free, untouched);
+    
+    // Interna: desperdício dentro dos blocos em uso; externa: memória livre
+    // que não está disponível como um único bloco contíguo
+    double internal = arena->live_block_bytes > 0
+        ? 1.0 - (double)arena->live_requested_bytes / arena->live_block_bytes : 0.0;
+    double external = free_bytes > 0 ? 1.0 - (double)largest_free / free_bytes : 0.0;
+    
+    out << "\"arena\": {";
+    out << "\"capacity\": " << SLAB_ARENA_SIZE << ",";
+    out << "\"live_blocks\": " << arena->live_blocks << ",";
+    out << "\"used_bytes\": " << arena->live_block_bytes << ",";
+    out << "\"requested_bytes\": " << arena->live_requested_bytes << ",";
+    out << "\"free_bytes\": " << free_bytes << ",";
+    out << "\"free_list_bytes\": " << free_list_bytes << ",";
+    out << "\"largest_free_block\": " << largest_free << ",";
+    out << "\"internal_fragmentation\": " << std::fixed << std::setprecision(3) << internal << ",";
+    out << "\"external_fragmentation\": " << external;
+    out.unsetf(std::ios::floatfield);
+    out << "},";
+}
+
+// Função para exibir o log compartilhado e a tabela de leitores em JSON
+void displayBroadcastState(std::ostream& out, BroadcastLog* log) {
+    uint64_t reserve = log->reserve.load(std::memory_order_acquire);
+    
+    out << "\"broadcast\": {";
+    out << "\"capacity\": " << BCAST_SLOTS << ",";
+    out << "\"slot_size\": " << BCAST_SLOT_SIZE << ",";
+    out << "\"written\": " << reserve << ",";
+    out << "\"rejected\": " << log->rejected.load(std::memory_order_relaxed) << ",";
+    out << "\"readers\": [";
+    bool first = true;
+    for (int i = 0; i < BCAST_MAX_READERS; i++) {
+        BroadcastReader& reader = log->readers[i];
+        int pid = reader.pid.load(std::memory_order_acquire);
+        if (pid <= 0) {
+            continue;
+        }
+        uint64_t cursor = reader.cursor.load(std::memory_order_acquire);
+        out << (first ? "" : ",") << "{";
+        out << "\"slot\": " << i << ",";
+        out << "\"pid\": " << pid << ",";
+        out << "\"cursor\": " << cursor << ",";
+        out << "\"lag\": " << (reserve > cursor ? reserve - cursor : 0) << ",";
+        out << "\"received\": " << reader.received.load(std::memory_order_relaxed) << ",";
+        out << "\"lagging\": " << (reader.lagging.load(std::memory_order_relaxed) ? "true" : "false");
+        out << "}";
+        first = false;
+    }
+    out << "]";
+    out << "},";
 }
 
 // Função para exibir estado da memória em JSON
-void displayMemoryState(SharedData* data, int shm_id, int sem_id) {
+void displayMemoryState(SharedSegment* segment, int shm_id, int sem_id) {
+    // Despejo após cada operação: com a categoria desligada não há semctl nem formatação
+    static LogCategory& category = logCategory("memory_state");
+    if (!logEnabled(category, LOG_DEBUG)) {
+        return;
+    }
+    
     int sem_val = semctl(sem_id, 0, GETVAL);
+    SharedData* data = &segment->data;
+    SegmentSync* sync = &segment->sync;
+    RingBuffer* ring = &segment->ring;
+
+    updateRingRates(ring);
+    uint64_t tail = ring->tail.load(std::memory_order_acquire);
+    uint64_t head = ring->head.load(std::memory_order_acquire);
+    
+    std::stringstream out;
+    out << "\"shm_id\": " << shm_id << ",";
+    out << "\"sem_id\": " << sem_id << ",";
+    out << "\"segment\": {";
+    out << "\"backend\": \"" << (segment_config.backend == BACKEND_POSIX ? "posix" : "sysv") << "\",";
+    if (segment_config.backend == BACKEND_POSIX) {
+        out << "\"name\": \"" << logEscape(segment_config.name) << "\",";
+    }
+    out << "\"size\": " << segment_config.mapped_size << ",";
+    out << "\"payload_capacity\": " << payloadCapacity() << ",";
+    out << "\"huge_pages\": " << (segment_config.huge_pages_active ? "true" : "false");
+    out << "},";
+    out << "\"memory\": {";
+    out << "\"message\": \"" << logEscape(data->message) << "\",";
+    out << "\"length\": " << data->length << ",";
+    out << "\"counter\": " << data->counter << ",";
+    out << "\"updated\": " << (data->updated ? "true" : "false") << ",";
+    out << "\"last_writer\": " << data->last_writer << ",";
+    out << "\"last_update\": " << data->last_update;
+    out << "},";
+    out << "\"ring\": {";
+    out << "\"capacity\": " << RING_SLOTS << ",";
+    out << "\"slot_size\": " << RING_SLOT_SIZE << ",";
+    out << "\"used\": " << (tail - head) << ",";
+    out << "\"written\": " << tail << ",";
+    out << "\"read\": " << head << ",";
+    out << "\"drops\": " << ring->drops.load(std::memory_order_relaxed) << ",";
+    out << "\"write_msgs_per_sec\": " << std::fixed << std::setprecision(1) << ring_rate.write_rate << ",";
+    out << "\"read_msgs_per_sec\": " << ring_rate.read_rate;
+    out.unsetf(std::ios::floatfield);
+    out << "},";
+    displayArenaState(out, &segment->arena);
+    displayBroadcastState(out, &segment->broadcast);
+    out << "\"lock\": {";
+    out << "\"mode\": \"" << lockModeName(sync->lock_mode.load()) << "\",";
+    out << "\"state\": " << sync->lock_word.load() << ",";
+    out << "\"owner\": " << sync->lock_owner.load() << ",";
+    out << "\"recoveries\": " << sync->recoveries.load() << ",";
+    out << "\"data_seq\": " << sync->data_seq.load() << ",";
+    out << "\"waiters\": " << sync->data_waiters.load() << ",";
+    out << "\"seqlock\": " << sync->seqlock.load();
+    out << "},";
+    out << "\"semaphore\": {";
+    out << "\"value\": " << sem_val << ",";
+    out << "\"available\": " << (sem_val > 0 ? "true" : "false");
+    out << "}";
     
-    std::cout << "{";
-    std::cout << "\"timestamp\": \"" << getTimestamp() << "\",";
-    std::cout << "\"type\": \"memory_state\",";
-    std::cout << "\"shm_id\": " << shm_id << ",";
-    std::cout << "\"sem_id\": " << sem_id << ",";
-    std::cout << "\"memory\": {";
-    std::cout << "\"message\": \"" << escapeJson(data->message) << "\",";
-    std::cout << "\"counter\": " << data->counter << ",";
-    std::cout << "\"updated\": " << (data->updated ? "true" : "false") << ",";
-    std::cout << "\"last_writer\": " << data->last_writer << ",";
-    std::cout << "\"last_update\": " << data->last_update;
-    std::cout << "},";
-    std::cout << "\"semaphore\": {";
-    std::cout << "\"value\": " << sem_val << ",";
-    std::cout << "\"available\": " << (sem_val > 0 ? "true" : "false");
-    std::cout << "}";
-    std::cout << "}" << std::endl;
-    std::cout.flush();
+    // Evento composto: campos aninhados já formatados, emitidos como os demais
+    LogLine& line = logBegin("memory_state");
+    logFields(line, out.str());
+    logEnd(line);
 }
 
 // Estrutura para gerenciar o estado da memória compartilhada
 struct SharedMemoryState {
     int shm_id;
     int sem_id;
+    SharedSegment* segment;
     SharedData* shared_data;
     bool memory_created;
     bool semaphore_created;
     bool attached;
     pid_t writer_pid;
     pid_t reader_pid;
+    uint64_t ring_cached_head;   // cópia local do head (evita ler a linha do consumidor)
+    uint64_t ring_cached_tail;   // cópia local do tail (evita ler a linha do produtor)
+    int seq_last_counter;        // último counter visto por seq_read neste processo
+    int broadcast_reader;        // entrada na tabela de leitores do log (-1 = não inscrito)
     
-    SharedMemoryState() : shm_id(-1), sem_id(-1), shared_data(nullptr),
+    SharedMemoryState() : shm_id(-1), sem_id(-1), segment(nullptr), shared_data(nullptr),
                          memory_created(false), semaphore_created(false),
-                         attached(false), writer_pid(-1), reader_pid(-1) {}
+                         attached(false), writer_pid(-1), reader_pid(-1),
+                         ring_cached_head(0), ring_cached_tail(0), seq_last_counter(-1),
+                         broadcast_reader(-1) {}
 };
 
 SharedMemoryState shm_state;
 
 // Funções para semáforos
+// SEM_UNDO: o kernel desfaz a operação se o processo terminar com o semáforo obtido
+// Com uma estratégia de espera ativa, tenta com IPC_NOWAIT antes de bloquear no semop
 void sem_lock(int sem_id) {
-    struct sembuf sb = {0, -1, 0};
+    struct sembuf sb = {0, -1, SEM_UNDO | IPC_NOWAIT};
+    if (waitSpin([&]() { return semop(sem_id, &sb, 1) == 0 || errno != EAGAIN; }, -1)) {
+        return;
+    }
+    sb.sem_flg = SEM_UNDO;
     semop(sem_id, &sb, 1);
 }
 
 void sem_unlock(int sem_id) {
-    struct sembuf sb = {0, 1, 0};
+    struct sembuf sb = {0, 1, SEM_UNDO};
     semop(sem_id, &sb, 1);
 }
 
+// Funções para futex compartilhado entre processos (sem FUTEX_PRIVATE_FLAG)
+long futexWait(std::atomic<int>* addr, int expected, const struct timespec* timeout = nullptr) {
+    return syscall(SYS_futex, reinterpret_cast<int*>(addr), FUTEX_WAIT, expected, timeout, nullptr, 0);
+}
+
+long futexWake(std::atomic<int>* addr, int count) {
+    return syscall(SYS_futex, reinterpret_cast<int*>(addr), FUTEX_WAKE, count, nullptr, nullptr, 0);
+}
+
+// Lock futex: 0 = livre, 1 = ocupado, 2 = ocupado com processos aguardando.
+// Sem disputa, lock e unlock são uma única operação atômica sem syscall.
+void futex_lock(std::atomic<int>* word) {
+    int c = 0;
+    if (word->compare_exchange_strong(c, 1, std::memory_order_acquire)) {
+        return;
+    }
+    if (waitSpin([&]() { c = 0; return word->compare_exchange_weak(c, 1, std::memory_order_acquire); }, -1)) {
+        return;
+    }
+    if (c != 2) {
+        c = word->exchange(2, std::memory_order_acquire);
+    }
+    while (c != 0) {
+        futexWait(word, 2);
+        c = word->exchange(2, std::memory_order_acquire);
+    }
+}
+
+void futex_unlock(std::atomic<int>* word) {
+    if (word->fetch_sub(1, std::memory_order_release) != 1) {
+        word->store(0, std::memory_order_release);
+        futexWake(word, 1);
+    }
+}
+
+// Checksum FNV-1a de SharedData (o payload externo não entra: só o cabeçalho)
+uint32_t sharedDataChecksum(const SharedData& data) {
+    uint32_t hash = 2166136261u;
+    auto mix = [&hash](const void* bytes, size_t length) {
+        const unsigned char* p = static_cast<const unsigned char*>(bytes);
+        for (size_t i = 0; i < length; i++) {
+            hash = (hash ^ p[i]) * 16777619u;
+        }
+    };
+    mix(data.message, sizeof(data.message));
+    mix(&data.counter, sizeof(data.counter));
+    mix(&data.last_writer, sizeof(data.last_writer));
+    mix(&data.last_update, sizeof(data.last_update));
+    mix(&data.length, sizeof(data.length));
+    return hash;
+}
+
+// Inicializa o mutex robusto uma única vez por segmento: o primeiro processo
+// vence o CAS em init_state e os demais aguardam o estado pronto
+void initRobustMutex(SegmentSync* sync) {
+    int state = 0;
+    if (!sync->init_state.compare_exchange_strong(state, 1, std::memory_order_acq_rel)) {
+        // Quem inicializa leva microssegundos; após 1s assume que morreu no meio
+        uint64_t deadline = monotonicNs() + 1000000000ULL;
+        while (sync->init_state.load(std::memory_order_acquire) != 2) {
+            if (monotonicNs() > deadline) {
+                logEvent("warning", "Inicialização do mutex robusto abandonada - refazendo", "main", getpid());
+                break;
+            }
+            sched_yield();
+        }
+        if (sync->init_state.load(std::memory_order_acquire) == 2) {
+            return;
+        }
+    }
+    
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+    pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+    pthread_mutex_init(&sync->robust_mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+    sync->lock_owner.store(0, std::memory_order_relaxed);
+    sync->init_state.store(2, std::memory_order_release);
+}
+
+// Recupera o segmento após a morte do dono do lock (chamada com o lock obtido):
+// fecha um seqlock deixado ímpar e valida SharedData pelo checksum
+void recoverSegment(pid_t owner) {
+    SegmentSync* sync = &shm_state.segment->sync;
+    SharedData* data = shm_state.shared_data;
+    
+    // Seqlock ímpar travaria os leitores sem lock indefinidamente
+    bool seqlock_open = (sync->seqlock.load(std::memory_order_relaxed) & 1) != 0;
+    if (seqlock_open) {
+        sync->seqlock.fetch_add(1, std::memory_order_release);
+    }
+    
+    // Escrita interrompida: a mensagem pode misturar a antiga e a nova, então
+    // é fechada, o payload descartado e ela não é entregue como dado novo
+    bool valid = data->checksum == sharedDataChecksum(*data);
+    if (!valid) {
+        sync->seqlock.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        data->message[sizeof(data->message) - 1] = '\0';
+        data->length = strlen(data->message);
+        data->updated = false;
+        data->checksum = sharedDataChecksum(*data);
+        sync->seqlock.fetch_add(1, std::memory_order_release);
+    }
+    
+    sync->recoveries.fetch_add(1, std::memory_order_relaxed);
+    logEvent("recovery", "Dono do lock terminou com o lock obtido - segmento recuperado", "main", getpid(),
+             "owner_pid=" + std::to_string(owner) +
+             " seqlock_closed=" + (seqlock_open ? "true" : "false") +
+             " checksum=" + (valid ? "ok" : "repaired"));
+}
+
+// Lock robusto: se o dono morreu, o próximo processo recebe EOWNERDEAD,
+// recupera o segmento e marca o mutex como consistente
+void robust_lock(SegmentSync* sync) {
+    int rc = pthread_mutex_lock(&sync->robust_mutex);
+    if (rc == EOWNERDEAD) {
+        recoverSegment(sync->lock_owner.load(std::memory_order_relaxed));
+        pthread_mutex_consistent(&sync->robust_mutex);
+    } else if (rc != 0) {
+        logEvent("error", "Erro ao obter mutex robusto: " + std::string(strerror(rc)), "main", getpid());
+    }
+    sync->lock_owner.store(getpid(), std::memory_order_relaxed);
+}
+
+void robust_unlock(SegmentSync* sync) {
+    sync->lock_owner.store(0, std::memory_order_relaxed);
+    pthread_mutex_unlock(&sync->robust_mutex);
+}
+
+// Semáforo com dono registrado: o SEM_UNDO devolve o semáforo de um dono
+// morto, mas o pid que ficou em lock_owner mostra que a escrita foi interrompida
+void sysv_lock(SegmentSync* sync) {
+    sem_lock(shm_state.sem_id);
+    pid_t owner = sync->lock_owner.load(std::memory_order_relaxed);
+    if (owner != 0) {
+        recoverSegment(owner);
+    }
+    sync->lock_owner.store(getpid(), std::memory_order_relaxed);
+}
+
+void sysv_unlock(SegmentSync* sync) {
+    sync->lock_owner.store(0, std::memory_order_relaxed);
+    sem_unlock(shm_state.sem_id);
+}
+
+// Funções de lock do segmento conforme o modo configurado
+void segment_lock() {
+    static SpanOp& lock_span = spanOp("shm.lock");
+    uint64_t span = spanStart();
+    SegmentSync* sync = &shm_state.segment->sync;
+    switch (sync->lock_mode.load(std::memory_order_relaxed)) {
+        case LOCK_SYSV: sysv_lock(sync); break;
+        case LOCK_ROBUST: robust_lock(sync); break;
+        default: futex_lock(&sync->lock_word); break;
+    }
+    spanEnd(lock_span, span);
+}
+
+void segment_unlock() {
+    SegmentSync* sync = &shm_state.segment->sync;
+    switch (sync->lock_mode.load(std::memory_order_relaxed)) {
+        case LOCK_SYSV: sysv_unlock(sync); break;
+        case LOCK_ROBUST: robust_unlock(sync); break;
+        default: futex_unlock(&sync->lock_word); break;
+    }
+}
+
+// Seqlock: o escritor (com o lock obtido) torna a sequência ímpar antes de
+// alterar SharedData e par depois; leitores copiam sem lock e repetem se ela mudou
+void seqlock_write_begin() {
+    std::atomic<uint32_t>& seq = shm_state.segment->sync.seqlock;
+    seq.store(seq.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+void seqlock_write_end() {
+    std::atomic<uint32_t>& seq = shm_state.segment->sync.seqlock;
+    seq.store(seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+// Cópia consistente dos campos lidos sem lock
+struct SharedDataSnapshot {
+    char message[sizeof(SharedData::message)];
+    int counter;
+    pid_t last_writer;
+};
+
+// Retorna o número de tentativas repetidas até obter uma cópia consistente
+unsigned seqlock_read(SharedDataSnapshot& snapshot) {
+    std::atomic<uint32_t>& seq = shm_state.segment->sync.seqlock;
+    const SharedData* data = shm_state.shared_data;
+    unsigned retries = 0;
+    
+    while (true) {
+        uint32_t begin = seq.load(std::memory_order_acquire);
+        if ((begin & 1) == 0) {
+            memcpy(snapshot.message, data->message, sizeof(snapshot.message));
+            snapshot.counter = data->counter;
+            snapshot.last_writer = data->last_writer;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (seq.load(std::memory_order_relaxed) == begin) {
+                break;
+            }
+        }
+        retries++;
+        
+        // Sequência ímpar persistente: o escritor pode ter morrido no meio da
+        // escrita; passar pelo lock dispara a recuperação nos modos robust e sysv
+        if ((retries & 0xFFFFF) == 0) {
+            segment_lock();
+            segment_unlock();
+        }
+    }
+    
+    snapshot.message[sizeof(snapshot.message) - 1] = '\0';
+    return retries;
+}
+
+// Sinaliza "dados disponíveis" (chamada com o lock do segmento obtido)
+void notifyDataAvailable() {
+    static SpanOp& wake_span = spanOp("shm.wakeup");
+    SegmentSync* sync = &shm_state.segment->sync;
+    sync->data_ns.store(monotonicNs(), std::memory_order_relaxed);
+    // seq_cst nos dois lados (como waitAndReadFromMemory): ou o escritor vê o
+    // leitor em data_waiters, ou o leitor vê o novo data_seq no FUTEX_WAIT
+    sync->data_seq.fetch_add(1, std::memory_order_seq_cst);
+    if (sync->data_waiters.load(std::memory_order_seq_cst) > 0) {
+        uint64_t span = spanStart();
+        futexWake(&sync->data_seq, INT_MAX);
+        spanEnd(wake_span, span);
+    }
+}
+
+// Função para criar o segmento System V (chave fixa)
+bool createSysvSegment() {
+    int flags = IPC_CREAT | 0666;
+    size_t size = std::max<size_t>(segment_config.size, SHM_SIZE);
+    
+    if (segment_config.hugetlb) {
+        size_t huge_size = (size + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+        shm_state.shm_id = shmget(SHM_KEY, huge_size, flags | SHM_HUGETLB);
+        if (shm_state.shm_id != -1) {
+            segment_config.huge_pages_active = true;
+        } else {
+            logEvent("warning", "SHM_HUGETLB indisponível, usando páginas normais: " +
+                     std::string(strerror(errno)), "main", getpid());
+        }
+    }
+    
+    if (shm_state.shm_id == -1) {
+        shm_state.shm_id = shmget(SHM_KEY, size, flags);
+    }
+    if (shm_state.shm_id == -1) {
+        logEvent("error", "Erro ao criar memória compartilhada: " + 
+                 std::string(strerror(errno)), "main", getpid());
+        return false;
+    }
+    
+    // O segmento pode já existir com outro tamanho
+    struct shmid_ds info;
+    if (shmctl(shm_state.shm_id, IPC_STAT, &info) == 0) {
+        segment_config.mapped_size = info.shm_segsz;
+    } else {
+        segment_config.mapped_size = size;
+    }
+    return true;
+}
+
+// Função para criar o segmento POSIX nomeado com tamanho configurável
+bool createPosixSegment() {
+    int fd = shm_open(segment_config.name.c_str(), O_CREAT | O_RDWR, 0666);
+    if (fd == -1) {
+        logEvent("error", "Erro ao criar memória compartilhada POSIX: " + 
+                 std::string(strerror(errno)), "main", getpid(), segment_config.name);
+        return false;
+    }
+    
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+        logEvent("error", "Erro ao consultar memória compartilhada POSIX: " + 
+                 std::string(strerror(errno)), "main", getpid(), segment_config.name);
+        close(fd);
+        return false;
+    }
+    
+    size_t size = std::max<size_t>(segment_config.size, SHM_SIZE);
+    if (segment_config.hugetlb) {
+        size = (size + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+    }
+    
+    if (st.st_size == 0) {
+        if (ftruncate(fd, size) == -1) {
+            logEvent("error", "Erro ao dimensionar memória compartilhada: " + 
+                     std::string(strerror(errno)), "main", getpid(), std::to_string(size));
+            close(fd);
+            shm_unlink(segment_config.name.c_str());
+            return false;
+        }
+    } else if ((size_t)st.st_size < SHM_SIZE) {
+        logEvent("error", "Segmento POSIX existente menor que o cabeçalho", "main", getpid(),
+                 "size=" + std::to_string(st.st_size));
+        close(fd);
+        return false;
+    } else {
+        // Outro processo já criou o segmento: respeitar o tamanho existente
+        size = st.st_size;
+    }
+    
+    shm_state.shm_id = fd;
+    segment_config.mapped_size = size;
+    return true;
+}
+
 // Função para criar memória compartilhada e semáforo
 void createSharedMemory() {
     if (shm_state.memory_created) {
@@ -141,15 +831,22 @@ void createSharedMemory() {
     }
     
     // Criar/obter memória compartilhada
-    shm_state.shm_id = shmget(SHM_KEY, SHM_SIZE, IPC_CREAT | 0666);
-    if (shm_state.shm_id == -1) {
-        logEvent("error", "Erro ao criar memória compartilhada: " + 
-                 std::string(strerror(errno)), "main", getpid());
+    bool created = segment_config.backend == BACKEND_POSIX ? createPosixSegment() : createSysvSegment();
+    if (!created) {
         return;
     }
     
+    // Cada segmento POSIX tem seu próprio semáforo, derivado do arquivo em /dev/shm
+    key_t sem_key = SEM_KEY;
+    if (segment_config.backend == BACKEND_POSIX) {
+        key_t derived = ftok(("/dev/shm" + segment_config.name).c_str(), 'S');
+        if (derived != -1) {
+            sem_key = derived;
+        }
+    }
+    
     // Criar/obter semáforo
-    shm_state.sem_id = semget(SEM_KEY, 1, IPC_CREAT | 0666);
+    shm_state.sem_id = semget(sem_key, 1, IPC_CREAT | 0666);
     if (shm_state.sem_id == -1) {
         logEvent("error", "Erro ao criar semáforo: " + 
                  std::string(strerror(errno)), "main", getpid());
@@ -168,7 +865,46 @@ void createSharedMemory() {
     
     logEvent("shm", "Memória compartilhada e semáforo criados", "main", getpid(),
              "shm_id=" + std::to_string(shm_state.shm_id) + 
-             " sem_id=" + std::to_string(shm_state.sem_id));
+             " sem_id=" + std::to_string(shm_state.sem_id) +
+             " backend=" + (segment_config.backend == BACKEND_POSIX ? "posix" : "sysv") +
+             " size=" + std::to_string(segment_config.mapped_size));
+}
+
+// Função para mapear o segmento POSIX com as dicas configuradas
+void* mapPosixSegment() {
+    int flags = MAP_SHARED;
+    if (segment_config.populate) {
+        flags |= MAP_POPULATE;
+    }
+    
+    void* addr = MAP_FAILED;
+    if (segment_config.hugetlb) {
+        addr = mmap(NULL, segment_config.mapped_size, PROT_READ | PROT_WRITE,
+                    flags | MAP_HUGETLB, shm_state.shm_id, 0);
+        if (addr == MAP_FAILED) {
+            logEvent("warning", "MAP_HUGETLB indisponível, usando madvise(MADV_HUGEPAGE): " +
+                     std::string(strerror(errno)), "main", getpid());
+        } else {
+            segment_config.huge_pages_active = true;
+        }
+    }
+    
+    if (addr == MAP_FAILED) {
+        addr = mmap(NULL, segment_config.mapped_size, PROT_READ | PROT_WRITE,
+                    flags, shm_state.shm_id, 0);
+        if (addr == MAP_FAILED) {
+            return addr;
+        }
+        // Páginas enormes transparentes para tmpfs (requer shmem_enabled=advise)
+        if (segment_config.hugetlb && madvise(addr, segment_config.mapped_size, MADV_HUGEPAGE) == 0) {
+            segment_config.huge_pages_active = true;
+        }
+    }
+    
+    if (segment_config.populate) {
+        madvise(addr, segment_config.mapped_size, MADV_WILLNEED);
+    }
+    return addr;
 }
 
 // Função para anexar à memória compartilhada
@@ -183,26 +919,37 @@ void attachToMemory() {
         return;
     }
     
-    shm_state.shared_data = (SharedData*)shmat(shm_state.shm_id, NULL, 0);
-    if (shm_state.shared_data == (void*)-1) {
+    void* addr = segment_config.backend == BACKEND_POSIX ? mapPosixSegment()
+                                                         : shmat(shm_state.shm_id, NULL, 0);
+    if (addr == (void*)-1) {
         logEvent("error", "Erro ao anexar memória compartilhada: " + 
                  std::string(strerror(errno)), "main", getpid());
         return;
     }
     
+    shm_state.segment = (SharedSegment*)addr;
+    shm_state.shared_data = &shm_state.segment->data;
+    shm_state.ring_cached_head = 0;
+    shm_state.ring_cached_tail = 0;
     shm_state.attached = true;
+    placementBindMemory(addr, segment_config.mapped_size, "main");
+    initRobustMutex(&shm_state.segment->sync);
     
     // Inicializar dados se for o primeiro
-    sem_lock(shm_state.sem_id);
+    segment_lock();
     if (shm_state.shared_data->counter == 0) {
+        seqlock_write_begin();
         strcpy(shm_state.shared_data->message, "Memória inicializada");
         shm_state.shared_data->counter = 0;
         shm_state.shared_data->updated = false;
         shm_state.shared_data->last_writer = 0;
         shm_state.shared_data->last_update = time(nullptr);
+        shm_state.shared_data->length = strlen(shm_state.shared_data->message);
+        shm_state.shared_data->checksum = sharedDataChecksum(*shm_state.shared_data);
+        seqlock_write_end();
         logEvent("shm", "Memória inicializada", "main", getpid());
     }
-    sem_unlock(shm_state.sem_id);
+    segment_unlock();
     
     logEvent("shm", "Memória compartilhada anexada", "main", getpid());
 }
@@ -214,72 +961,1099 @@ void writeToMemory(const std::string& message) {
         return;
     }
     
-    logEvent("operation", "Aguardando semáforo para escrita", "writer", getpid());
+    LOG_EVENT(LOG_DEBUG, "operation", "Aguardando semáforo para escrita", "writer", getpid());
     
-    sem_lock(shm_state.sem_id);
-    logEvent("semaphore", "Semáforo obtido - escrevendo", "writer", getpid());
+    segment_lock();
+    LOG_EVENT(LOG_DEBUG, "semaphore", "Semáforo obtido - escrevendo", "writer", getpid());
+    
+    // Mensagens longas vão inteiras para a área de payload; o campo fixo guarda o prefixo
+    static SpanOp& copy_span = spanOp("shm.copy");
+    uint64_t span = spanStart();
+    size_t length = message.length();
+    if (length >= sizeof(shm_state.shared_data->message)) {
+        size_t capacity = payloadCapacity();
+        if (length > capacity) {
+            logEvent("warning", "Mensagem truncada para a capacidade do segmento", "writer", getpid(),
+                     "bytes=" + std::to_string(length) + " capacity=" +
+                     std::to_string(std::max(capacity, sizeof(shm_state.shared_data->message) - 1)));
+            length = std::max(capacity, sizeof(shm_state.shared_data->message) - 1);
+        }
+        memcpy(payloadArea(shm_state.segment), message.data(), std::min(length, capacity));
+    }
     
     // Escrever na memória compartilhada
+    seqlock_write_begin();
     strncpy(shm_state.shared_data->message, message.c_str(), 
             sizeof(shm_state.shared_data->message) - 1);
     shm_state.shared_data->message[sizeof(shm_state.shared_data->message) - 1] = '\0';
+    shm_state.shared_data->length = length;
     shm_state.shared_data->counter++;
     shm_state.shared_data->updated = true;
     shm_state.shared_data->last_writer = getpid();
     shm_state.shared_data->last_update = time(nullptr);
+    shm_state.shared_data->checksum = sharedDataChecksum(*shm_state.shared_data);
+    seqlock_write_end();
+    spanEnd(copy_span, span);
+    notifyDataAvailable();
     
-    logEvent("write", "Dados escritos na memória", "writer", getpid(), message);
-    displayMemoryState(shm_state.shared_data, shm_state.shm_id, shm_state.sem_id);
+    segment_unlock();
+    LOG_EVENT(LOG_DEBUG, "semaphore", "Semáforo liberado", "writer", getpid());
     
-    sem_unlock(shm_state.sem_id);
-    logEvent("semaphore", "Semáforo liberado", "writer", getpid());
+    // Log e despejo do estado fora do lock: não atrasam outros processos
+    LOG_EVENT(LOG_INFO, "write", "Dados escritos na memória", "writer", getpid(), message);
+    displayMemoryState(shm_state.segment, shm_state.shm_id, shm_state.sem_id);
 }
 
-// Função para ler da memória compartilhada
-void readFromMemory() {
+// Simula a morte de um escritor no meio da escrita (teste de recuperação):
+// obtém o lock, grava parte da mensagem e termina sem liberar nada
+void crashDuringWrite(const std::string& message) {
     if (!shm_state.attached) {
-        logEvent("error", "Não anexado à memória compartilhada", "reader", getpid());
+        logEvent("error", "Não anexado à memória compartilhada", "writer", getpid());
         return;
     }
     
-    logEvent("operation", "Aguardando semáforo para leitura", "reader", getpid());
-    
-    sem_lock(shm_state.sem_id);
-    logEvent("semaphore", "Semáforo obtido - lendo", "reader", getpid());
+    logEvent("warning", "Simulando falha do escritor com o lock obtido", "writer", getpid(),
+             lockModeName(shm_state.segment->sync.lock_mode.load()));
+    logFlush();
     
-    // Ler da memória compartilhada
-    if (shm_state.shared_data->updated) {
-        logEvent("read", "Dados lidos da memória", "reader", getpid(), 
-                shm_state.shared_data->message);
-        shm_state.shared_data->updated = false;
+    segment_lock();
+    seqlock_write_begin();
+    size_t partial = std::min(message.length() / 2, sizeof(shm_state.shared_data->message) - 1);
+    memcpy(shm_state.shared_data->message, message.data(), partial);
+    shm_state.shared_data->counter++;
+    _exit(1);
+}
+
+// Consome os dados da memória compartilhada (chamada com o lock obtido):
+// só copia a mensagem; retorna false se não havia dado novo
+bool consumeSharedData(std::string& message) {
+    if (!shm_state.shared_data->updated) {
+        return false;
+    }
+    message = storedMessage(shm_state.segment);
+    shm_state.shared_data->updated = false;
+    return true;
+}
+
+// Relata a leitura depois de liberar o lock (log e despejo do estado)
+void reportConsumed(bool consumed, const std::string& message) {
+    if (consumed) {
+        LOG_EVENT(LOG_INFO, "read", "Dados lidos da memória", "reader", getpid(), message);
     } else {
         logEvent("read", "Nenhum dado novo", "reader", getpid());
     }
     
-    displayMemoryState(shm_state.shared_data, shm_state.shm_id, shm_state.sem_id);
+    displayMemoryState(shm_state.segment, shm_state.shm_id, shm_state.sem_id);
+}
+
+// Função para ler da memória compartilhada
+void readFromMemory() {
+    if (!shm_state.attached) {
+        logEvent("error", "Não anexado à memória compartilhada", "reader", getpid());
+        return;
+    }
     
-    sem_unlock(shm_state.sem_id);
-    logEvent("semaphore", "Semáforo liberado", "reader", getpid());
+    LOG_EVENT(LOG_DEBUG, "operation", "Aguardando semáforo para leitura", "reader", getpid());
+    
+    segment_lock();
+    LOG_EVENT(LOG_DEBUG, "semaphore", "Semáforo obtido - lendo", "reader", getpid());
+    
+    std::string message;
+    bool consumed = consumeSharedData(message);
+    
+    segment_unlock();
+    LOG_EVENT(LOG_DEBUG, "semaphore", "Semáforo liberado", "reader", getpid());
+    reportConsumed(consumed, message);
 }
 
-// Função para limpar recursos
-void cleanupMemory() {
-    if (!shm_state.memory_created) {
-        logEvent("warning", "Memória não foi criada", "cleaner", getpid());
+// Função para ler sem lock via seqlock (não altera "updated", vários leitores em paralelo)
+void seqReadFromMemory() {
+    if (!shm_state.attached) {
+        logEvent("error", "Não anexado à memória compartilhada", "reader", getpid());
         return;
     }
     
-    logEvent("operation", "Iniciando limpeza de recursos", "cleaner", getpid());
+    SharedDataSnapshot snapshot;
+    unsigned retries = seqlock_read(snapshot);
     
-    sem_lock(shm_state.sem_id);
+    std::string details = "counter=" + std::to_string(snapshot.counter) +
+                          " last_writer=" + std::to_string(snapshot.last_writer) +
+                          " retries=" + std::to_string(retries);
     
-    // Remover memória compartilhada
-    if (shmctl(shm_state.shm_id, IPC_RMID, NULL) == 0) {
-        logEvent("shm", "Memória compartilhada removida", "cleaner", getpid());
-        shm_state.memory_created = false;
+    if (snapshot.counter != shm_state.seq_last_counter) {
+        shm_state.seq_last_counter = snapshot.counter;
+        logEvent("read", "Dados lidos via seqlock (" + details + ")", "reader", getpid(), snapshot.message);
     } else {
-        logEvent("error", "Erro ao remover memória: " + 
-                 std::string(strerror(errno)), "cleaner", getpid());
+        logEvent("read", "Nenhum dado novo via seqlock (" + details + ")", "reader", getpid());
+    }
+}
+
+// Função para medir a vazão de leituras via seqlock neste processo
+void benchmarkSeqRead(long iterations) {
+    if (!shm_state.attached) {
+        logEvent("error", "Não anexado à memória compartilhada", "reader", getpid());
+        return;
+    }
+    
+    SharedDataSnapshot snapshot;
+    unsigned long long retries = 0;
+    uint64_t start = monotonicNs();
+    for (long i = 0; i < iterations; i++) {
+        retries += seqlock_read(snapshot);
+    }
+    uint64_t elapsed = monotonicNs() - start;
+    
+    std::stringstream ss;
+    ss << "iterations=" << iterations << " retries=" << retries
+       << " reads_per_sec=" << std::fixed << std::setprecision(0) << iterations / (elapsed / 1e9)
+       << " ns_per_read=" << std::setprecision(1) << (double)elapsed / iterations;
+    logEvent("benchmark", "Benchmark de leitura seqlock concluído", "reader", getpid(), ss.str());
+}
+
+// Função para bloquear até que haja dados novos (timeout_ms <= 0 espera indefinidamente)
+void waitAndReadFromMemory(int timeout_ms) {
+    if (!shm_state.attached) {
+        logEvent("error", "Não anexado à memória compartilhada", "reader", getpid());
+        return;
+    }
+    
+    SegmentSync* sync = &shm_state.segment->sync;
+    uint64_t deadline = timeout_ms > 0 ? monotonicNs() + (uint64_t)timeout_ms * 1000000ULL : 0;
+    
+    logEvent("operation", "Aguardando dados novos na memória", "reader", getpid());
+    
+    static WaitSite wake_site("shm.wake");
+    bool waited = false;
+    segment_lock();
+    while (!shm_state.shared_data->updated) {
+        // data_seq é lido com o lock obtido: qualquer escrita posterior o altera
+        // e faz o FUTEX_WAIT retornar imediatamente
+        int seq = sync->data_seq.load(std::memory_order_acquire);
+        segment_unlock();
+        waited = true;
+        
+        // Fase de spin da estratégia configurada; só bloqueia no futex se não bastar
+        int64_t spin_timeout = -1;
+        if (deadline != 0) {
+            uint64_t now = monotonicNs();
+            spin_timeout = now < deadline ? (int64_t)(deadline - now) : 0;
+        }
+        long rc = 0;
+        int wait_errno = 0;
+        if (!waitSpin([&]() { return sync->data_seq.load(std::memory_order_acquire) != seq; }, spin_timeout)) {
+            struct timespec ts;
+            struct timespec* timeout = nullptr;
+            if (deadline != 0) {
+                uint64_t now = monotonicNs();
+                uint64_t remaining = now < deadline ? deadline - now : 0;
+                ts.tv_sec = remaining / 1000000000ULL;
+                ts.tv_nsec = remaining % 1000000000ULL;
+                timeout = &ts;
+            }
+            static SpanOp& wait_span = spanOp("shm.wait");
+            sync->data_waiters.fetch_add(1, std::memory_order_seq_cst);
+            if (sync->data_seq.load(std::memory_order_seq_cst) == seq) {
+                uint64_t span = spanStart();
+                rc = futexWait(&sync->data_seq, seq, timeout);
+                spanEnd(wait_span, span);
+                wait_errno = errno;
+            }
+            sync->data_waiters.fetch_sub(1, std::memory_order_relaxed);
+        }
+        
+        segment_lock();
+        if (rc == -1 && wait_errno == ETIMEDOUT && !shm_state.shared_data->updated) {
+            segment_unlock();
+            logEvent("read", "Tempo de espera esgotado sem dados novos", "reader", getpid(),
+                     "timeout_ms=" + std::to_string(timeout_ms));
+            return;
+        }
+    }
+    LOG_EVENT(LOG_DEBUG, "semaphore", "Dados disponíveis - lendo", "reader", getpid());
+    
+    std::string message;
+    uint64_t published_ns = sync->data_ns.load(std::memory_order_relaxed);
+    bool consumed = consumeSharedData(message);
+    
+    segment_unlock();
+    if (waited) {
+        waitRecordWakeup(wake_site, published_ns);
+    }
+    LOG_EVENT(LOG_DEBUG, "semaphore", "Semáforo liberado", "reader", getpid());
+    reportConsumed(consumed, message);
+}
+
+// Função para alterar o modo de lock compartilhado (usar apenas com o segmento ocioso)
+void setLockMode(const std::string& mode) {
+    if (!shm_state.attached) {
+        logEvent("error", "Não anexado à memória compartilhada", "main", getpid());
+        return;
+    }
+    
+    if (mode == "futex") {
+        shm_state.segment->sync.lock_mode.store(LOCK_FUTEX);
+    } else if (mode == "sysv") {
+        shm_state.segment->sync.lock_mode.store(LOCK_SYSV);
+    } else if (mode == "robust") {
+        shm_state.segment->sync.lock_mode.store(LOCK_ROBUST);
+    } else {
+        logEvent("error", "Modo de lock desconhecido (use futex, sysv ou robust): " + mode, "main", getpid());
+        return;
+    }
+    
+    logEvent("config", "Modo de lock alterado", "main", getpid(), mode);
+}
+
+// Função para medir o custo de lock/unlock sem disputa no modo atual
+void benchmarkLock(long iterations) {
+    if (!shm_state.attached) {
+        logEvent("error", "Não anexado à memória compartilhada", "main", getpid());
+        return;
+    }
+    
+    uint64_t start = monotonicNs();
+    for (long i = 0; i < iterations; i++) {
+        segment_lock();
+        segment_unlock();
+    }
+    uint64_t elapsed = monotonicNs() - start;
+    
+    const char* mode = lockModeName(shm_state.segment->sync.lock_mode.load());
+    std::stringstream ss;
+    ss << "mode=" << mode << " iterations=" << iterations
+       << " ns_per_op=" << std::fixed << std::setprecision(1) << (double)elapsed / iterations;
+    logEvent("benchmark", "Benchmark de lock concluído", "main", getpid(), ss.str());
+}
+
+// Função para escrever no ring buffer (produtor único, sem semáforo)
+void ringWrite(const std::string& message) {
+    if (!shm_state.attached) {
+        logEvent("error", "Não anexado à memória compartilhada", "writer", getpid());
+        return;
+    }
+    
+    RingBuffer* ring = &shm_state.segment->ring;
+    uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+    
+    // Só relê o head compartilhado quando a cópia local indica anel cheio
+    if (tail - shm_state.ring_cached_head >= RING_SLOTS) {
+        shm_state.ring_cached_head = ring->head.load(std::memory_order_acquire);
+        if (tail - shm_state.ring_cached_head >= RING_SLOTS) {
+            ring->drops.fetch_add(1, std::memory_order_relaxed);
+            logEvent("warning", "Ring buffer cheio - mensagem descartada", "writer", getpid(), message);
+            displayMemoryState(shm_state.segment, shm_state.shm_id, shm_state.sem_id);
+            return;
+        }
+    }
+    
+    RingSlot& slot = ring->slots[tail & (RING_SLOTS - 1)];
+    size_t length = message.length();
+    if (length > sizeof(slot.data)) {
+        logEvent("warning", "Mensagem truncada para o tamanho do slot", "writer", getpid(),
+                 "bytes=" + std::to_string(length) + " slot=" + std::to_string(sizeof(slot.data)));
+        length = sizeof(slot.data);
+    }
+    static SpanOp& copy_span = spanOp("shm.ring_copy");
+    uint64_t span = spanStart();
+    memcpy(slot.data, message.data(), length);
+    slot.length = (uint32_t)length;
+    
+    // Publica o slot para o consumidor
+    ring->tail.store(tail + 1, std::memory_order_release);
+    spanEnd(copy_span, span);
+    
+    LOG_EVENT(LOG_INFO, "write", "Dados escritos no ring buffer", "writer", getpid(), message.substr(0, length));
+    displayMemoryState(shm_state.segment, shm_state.shm_id, shm_state.sem_id);
+}
+
+// Função para ler todas as mensagens pendentes do ring buffer (consumidor único)
+void ringRead() {
+    if (!shm_state.attached) {
+        logEvent("error", "Não anexado à memória compartilhada", "reader", getpid());
+        return;
+    }
+    
+    RingBuffer* ring = &shm_state.segment->ring;
+    uint64_t head = ring->head.load(std::memory_order_relaxed);
+    
+    // Só relê o tail compartilhado quando a cópia local já foi consumida
+    if (shm_state.ring_cached_tail <= head) {
+        shm_state.ring_cached_tail = ring->tail.load(std::memory_order_acquire);
+    }
+    
+    if (head == shm_state.ring_cached_tail) {
+        logEvent("read", "Nenhum dado novo no ring buffer", "reader", getpid());
+    }
+    
+    while (head != shm_state.ring_cached_tail) {
+        RingSlot& slot = ring->slots[head & (RING_SLOTS - 1)];
+        std::string message(slot.data, slot.length);
+        
+        // Libera o slot para o produtor
+        ring->head.store(++head, std::memory_order_release);
+        LOG_EVENT(LOG_INFO, "read", "Dados lidos do ring buffer", "reader", getpid(), message);
+    }
+    
+    displayMemoryState(shm_state.segment, shm_state.shm_id, shm_state.sem_id);
+}
+
+// Menor cursor entre os leitores ativos; sem leitores, o próprio position
+uint64_t broadcastMinCursor(BroadcastLog* log, uint64_t position, int& slowest) {
+    uint64_t min_cursor = position;
+    slowest = -1;
+    for (int i = 0; i < BCAST_MAX_READERS; i++) {
+        BroadcastReader& reader = log->readers[i];
+        if (reader.pid.load(std::memory_order_acquire) <= 0) {
+            continue;
+        }
+        uint64_t cursor = reader.cursor.load(std::memory_order_acquire);
+        if (cursor < min_cursor) {
+            min_cursor = cursor;
+            slowest = i;
+        }
+    }
+    return min_cursor;
+}
+
+// Relata leitores atrasados (uma vez por episódio) e libera entradas de
+// processos que terminaram sem sair do log
+void broadcastCheckReaders(BroadcastLog* log, uint64_t position) {
+    for (int i = 0; i < BCAST_MAX_READERS; i++) {
+        BroadcastReader& reader = log->readers[i];
+        int pid = reader.pid.load(std::memory_order_acquire);
+        if (pid <= 0) {
+            continue;
+        }
+        uint64_t cursor = reader.cursor.load(std::memory_order_acquire);
+        uint64_t lag = position > cursor ? position - cursor : 0;
+        if (lag < BCAST_LAG_WARN) {
+            continue;
+        }
+    
+        std::string details = "reader_pid=" + std::to_string(pid) + " lag=" + std::to_string(lag) +
+                              " capacity=" + std::to_string(BCAST_SLOTS);
+        if (kill(pid, 0) == -1 && errno == ESRCH) {
+            if (reader.pid.compare_exchange_strong(pid, 0, std::memory_order_acq_rel)) {
+                logEvent("warning", "Leitor do log encerrado sem sair - entrada liberada", "writer", getpid(), details);
+            }
+            continue;
+        }
+        if (reader.lagging.exchange(1, std::memory_order_relaxed) == 0) {
+            logEvent("warning", "Leitor atrasado no log compartilhado", "writer", getpid(), details);
+        }
+    }
+}
+
+// Escritor que assumiu o slot para position (0 se ninguém assumiu); retorna
+// true enquanto esse processo existir
+bool broadcastOwnerAlive(BroadcastSlot& slot, uint64_t position, pid_t& owner) {
+    owner = slot.claimed.load(std::memory_order_acquire) == position ? slot.writer : 0;
+    return owner > 0 && !(kill(owner, 0) == -1 && errno == ESRCH);
+}
+
+// Função para publicar uma mensagem no log compartilhado (vários escritores)
+void broadcastWrite(const std::string& message) {
+    if (!shm_state.attached) {
+        logEvent("error", "Não anexado à memória compartilhada", "writer", getpid());
+        return;
+    }
+    
+    BroadcastLog* log = &shm_state.segment->broadcast;
+    uint64_t position = log->reserve.load(std::memory_order_acquire);
+    uint64_t min_cursor;
+    int slowest;
+    bool checked = false;
+    
+    // Reserva atômica: a posição só é tomada se não alcançar o slot que o
+    // leitor mais lento ainda não leu; o CAS falho recarrega position
+    while (true) {
+        min_cursor = broadcastMinCursor(log, position, slowest);
+        if (position - min_cursor < BCAST_SLOTS) {
+            if (log->reserve.compare_exchange_weak(position, position + 1, std::memory_order_acq_rel,
+                                                   std::memory_order_acquire)) {
+                break;
+            }
+            continue;
+        }
+    
+        // Log cheio: relata os atrasados (e libera leitores mortos) antes de recusar
+        if (!checked) {
+            broadcastCheckReaders(log, position);
+            checked = true;
+            continue;
+        }
+        log->rejected.fetch_add(1, std::memory_order_relaxed);
+        logEvent("warning", "Log compartilhado cheio - mensagem recusada", "writer", getpid(),
+                 "slowest_pid=" + std::to_string(log->readers[slowest].pid.load()) +
+                 " lag=" + std::to_string(position - min_cursor));
+        displayMemoryState(shm_state.segment, shm_state.shm_id, shm_state.sem_id);
+        return;
+    }
+    
+    if (position - min_cursor >= BCAST_LAG_WARN) {
+        broadcastCheckReaders(log, position);
+    }
+    
+    // O slot pode ainda estar com o escritor da volta anterior (sem leitores, ou
+    // depois que os leitores saltaram a posição dele). Se ele não publicar no
+    // prazo e tiver morrido (ou morreu antes de assumir o slot), o slot é
+    // assumido e a mensagem dele é dada como perdida
+    BroadcastSlot& slot = log->slots[position & (BCAST_SLOTS - 1)];
+    uint64_t previous = position >= BCAST_SLOTS ? position - BCAST_SLOTS + 1 : 0;
+    uint64_t deadline = monotonicNs() + BCAST_WRITER_TIMEOUT_NS;
+    while (slot.sequence.load(std::memory_order_acquire) != previous) {
+        if (monotonicNs() < deadline) {
+            sched_yield();
+            continue;
+        }
+        uint64_t stuck = position - BCAST_SLOTS;
+        pid_t owner;
+        if (broadcastOwnerAlive(slot, stuck, owner)) {
+            deadline = monotonicNs() + BCAST_WRITER_TIMEOUT_NS;
+            continue;
+        }
+        logEvent("warning", "Escritor do log encerrado sem publicar - slot assumido", "writer", getpid(),
+                 "position=" + std::to_string(stuck) + " writer_pid=" + std::to_string(owner));
+        break;
+    }
+    slot.writer = getpid();
+    slot.claimed.store(position, std::memory_order_release);
+    
+    size_t length = message.length();
+    if (length > sizeof(slot.data)) {
+        logEvent("warning", "Mensagem truncada para o tamanho do slot", "writer", getpid(),
+                 "bytes=" + std::to_string(length) + " slot=" + std::to_string(sizeof(slot.data)));
+        length = sizeof(slot.data);
+    }
+    memcpy(slot.data, message.data(), length);
+    slot.length = (uint32_t)length;
+    
+    // Publica a posição para todos os leitores
+    slot.sequence.store(position + 1, std::memory_order_release);
+    
+    LOG_EVENT(LOG_INFO, "write", "Dados publicados no log compartilhado", "writer", getpid(), message.substr(0, length));
+    displayMemoryState(shm_state.segment, shm_state.shm_id, shm_state.sem_id);
+}
+
+// Função para inscrever este processo como leitor do log compartilhado
+void broadcastJoin() {
+    if (!shm_state.attached) {
+        logEvent("error", "Não anexado à memória compartilhada", "reader", getpid());
+        return;
+    }
+    if (shm_state.broadcast_reader >= 0) {
+        logEvent("warning", "Já inscrito como leitor do log compartilhado", "reader", getpid());
+        return;
+    }
+    
+    BroadcastLog* log = &shm_state.segment->broadcast;
+    for (int i = 0; i < BCAST_MAX_READERS; i++) {
+        BroadcastReader& reader = log->readers[i];
+        int expected = 0;
+        // -1 reserva a entrada sem que os escritores considerem o cursor antigo
+        if (!reader.pid.compare_exchange_strong(expected, -1, std::memory_order_acq_rel)) {
+            continue;
+        }
+    
+        // O leitor recebe apenas o que for publicado depois de entrar
+        uint64_t cursor = log->reserve.load(std::memory_order_acquire);
+        reader.cursor.store(cursor, std::memory_order_relaxed);
+        reader.received.store(0, std::memory_order_relaxed);
+        reader.lagging.store(0, std::memory_order_relaxed);
+        reader.pid.store(getpid(), std::memory_order_release);
+        shm_state.broadcast_reader = i;
+    
+        logEvent("broadcast", "Leitor inscrito no log compartilhado", "reader", getpid(),
+                 "slot=" + std::to_string(i) + " cursor=" + std::to_string(cursor));
+        displayMemoryState(shm_state.segment, shm_state.shm_id, shm_state.sem_id);
+        return;
+    }
+    
+    logEvent("error", "Tabela de leitores do log cheia", "reader", getpid(),
+             "max_readers=" + std::to_string(BCAST_MAX_READERS));
+}
+
+// Função para retirar este processo da tabela de leitores
+void broadcastLeave() {
+    if (shm_state.broadcast_reader < 0) {
+        logEvent("warning", "Não inscrito como leitor do log compartilhado", "reader", getpid());
+        return;
+    }
+    
+    BroadcastReader& reader = shm_state.segment->broadcast.readers[shm_state.broadcast_reader];
+    int self = getpid();
+    reader.pid.compare_exchange_strong(self, 0, std::memory_order_acq_rel);
+    
+    logEvent("broadcast", "Leitor saiu do log compartilhado", "reader", getpid(),
+             "slot=" + std::to_string(shm_state.broadcast_reader) +
+             " received=" + std::to_string(reader.received.load(std::memory_order_relaxed)));
+    shm_state.broadcast_reader = -1;
+}
+
+// Função para ler, a partir do próprio cursor, tudo o que já foi publicado
+void broadcastRead() {
+    if (!shm_state.attached) {
+        logEvent("error", "Não anexado à memória compartilhada", "reader", getpid());
+        return;
+    }
+    if (shm_state.broadcast_reader < 0) {
+        logEvent("error", "Processo não inscrito como leitor (use bcast_join)", "reader", getpid());
+        return;
+    }
+    
+    BroadcastLog* log = &shm_state.segment->broadcast;
+    BroadcastReader& reader = log->readers[shm_state.broadcast_reader];
+    if (reader.pid.load(std::memory_order_acquire) != getpid()) {
+        logEvent("error", "Entrada de leitor perdida - inscreva-se novamente", "reader", getpid());
+        shm_state.broadcast_reader = -1;
+        return;
+    }
+    
+    uint64_t cursor = reader.cursor.load(std::memory_order_relaxed);
+    uint64_t count = 0;
+    
+    while (true) {
+        BroadcastSlot& slot = log->slots[cursor & (BCAST_SLOTS - 1)];
+        uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+    
+        // Ainda não publicado: a entrega é em ordem, então para aqui. Se a posição
+        // já foi reservada, espera o escritor até o prazo; se ele morreu (ou nunca
+        // assumiu o slot) a mensagem é dada como perdida e o cursor salta a posição,
+        // senão os escritores ficariam presos atrás deste cursor
+        if (sequence < cursor + 1) {
+            if (cursor >= log->reserve.load(std::memory_order_acquire)) {
+                break;
+            }
+            uint64_t deadline = monotonicNs() + BCAST_WRITER_TIMEOUT_NS;
+            while (slot.sequence.load(std::memory_order_acquire) < cursor + 1 && monotonicNs() < deadline) {
+                sched_yield();
+            }
+            if (slot.sequence.load(std::memory_order_acquire) >= cursor + 1) {
+                continue;
+            }
+            pid_t owner;
+            if (broadcastOwnerAlive(slot, cursor, owner)) {
+                break;
+            }
+            logEvent("warning", "Escritor do log encerrado sem publicar - mensagem perdida", "reader", getpid(),
+                     "position=" + std::to_string(cursor) + " writer_pid=" + std::to_string(owner));
+            reader.cursor.store(++cursor, std::memory_order_release);
+            continue;
+        }
+    
+        if (sequence == cursor + 1) {
+            std::string message(slot.data, std::min<size_t>(slot.length, sizeof(slot.data)));
+    
+            // Confirma que o slot não foi reutilizado durante a cópia
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) == cursor + 1) {
+                reader.cursor.store(++cursor, std::memory_order_release);
+                count++;
+                LOG_EVENT(LOG_INFO, "read", "Dados lidos do log compartilhado", "reader", getpid(), message);
+                continue;
+            }
+        }
+    
+        // Slot reutilizado antes da leitura (só ocorre em corrida com a inscrição):
+        // relata a perda e salta para a mensagem mais antiga ainda disponível
+        uint64_t reserve = log->reserve.load(std::memory_order_acquire);
+        uint64_t oldest = std::max(cursor + 1, reserve > BCAST_SLOTS ? reserve - BCAST_SLOTS : 0);
+        logEvent("warning", "Mensagens sobrescritas antes da leitura", "reader", getpid(),
+                 "lost=" + std::to_string(oldest - cursor));
+        cursor = oldest;
+        reader.cursor.store(cursor, std::memory_order_release);
+    }
+    
+    if (count == 0) {
+        logEvent("read", "Nenhum dado novo no log compartilhado", "reader", getpid());
+    }
+    reader.received.fetch_add(count, std::memory_order_relaxed);
+    
+    uint64_t lag = log->reserve.load(std::memory_order_acquire) - cursor;
+    if (lag < BCAST_LAG_WARN / 2 && reader.lagging.exchange(0, std::memory_order_relaxed) == 1) {
+        logEvent("broadcast", "Leitor recuperou o atraso no log compartilhado", "reader", getpid(),
+                 "lag=" + std::to_string(lag));
+    }
+    
+    displayMemoryState(shm_state.segment, shm_state.shm_id, shm_state.sem_id);
+}
+
+// Nome do segmento de snapshot, derivado do nome POSIX configurado
+std::string snapshotName() {
+    return segment_config.name + ".snap";
+}
+
+// Garante que [0, end) esteja mapeado localmente, acompanhando o crescimento
+// do segmento; em falha o mapeamento anterior continua válido
+bool snapshotMapTo(uint64_t end) {
+    if (end <= snapshot_map.mapped) {
+        return true;
+    }
+    
+    struct stat st;
+    if (fstat(snapshot_map.fd, &st) == -1 || (uint64_t)st.st_size < end) {
+        return false;
+    }
+    void* addr = mremap(snapshot_map.base, snapshot_map.mapped, st.st_size, MREMAP_MAYMOVE);
+    if (addr == MAP_FAILED) {
+        logEvent("error", "Erro ao remapear o segmento de snapshot: " +
+                 std::string(strerror(errno)), "main", getpid());
+        return false;
+    }
+    snapshot_map.base = static_cast<char*>(addr);
+    snapshot_map.mapped = st.st_size;
+    return true;
+}
+
+SnapshotHeader* snapshotHeader() {
+    return reinterpret_cast<SnapshotHeader*>(snapshot_map.base);
+}
+
+// Função para abrir (e, no primeiro processo, criar) o segmento de snapshot
+SnapshotHeader* openSnapshot() {
+    if (snapshot_map.base != nullptr) {
+        return snapshotHeader();
+    }
+    if (!shm_state.attached) {
+        logEvent("error", "Não anexado à memória compartilhada", "main", getpid());
+        return nullptr;
+    }
+    
+    std::string name = snapshotName();
+    int fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0666);
+    if (fd == -1) {
+        logEvent("error", "Erro ao criar segmento de snapshot: " +
+                 std::string(strerror(errno)), "main", getpid(), name);
+        return nullptr;
+    }
+    
+    uint64_t initial = sizeof(SnapshotHeader) + (uint64_t)SNAP_BUFFERS * SNAP_INITIAL_CAPACITY;
+    struct stat st;
+    if (fstat(fd, &st) == -1 || (st.st_size == 0 && ftruncate(fd, initial) == -1)) {
+        logEvent("error", "Erro ao dimensionar segmento de snapshot: " +
+                 std::string(strerror(errno)), "main", getpid(), name);
+        close(fd);
+        return nullptr;
+    }
+    
+    size_t size = std::max<uint64_t>(st.st_size, initial);
+    void* addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED) {
+        logEvent("error", "Erro ao mapear segmento de snapshot: " +
+                 std::string(strerror(errno)), "main", getpid(), name);
+        close(fd);
+        return nullptr;
+    }
+    snapshot_map.fd = fd;
+    snapshot_map.base = static_cast<char*>(addr);
+    snapshot_map.mapped = size;
+    placementBindMemory(addr, size, "main");
+    
+    // O primeiro processo vence o CAS e distribui os buffers; os demais aguardam.
+    // Quem inicializa leva microssegundos; após 1s assume que morreu no meio e refaz
+    SnapshotHeader* header = snapshotHeader();
+    int state = 0;
+    bool initialize = header->init_state.compare_exchange_strong(state, 1, std::memory_order_acq_rel);
+    if (!initialize) {
+        uint64_t deadline = monotonicNs() + 1000000000ULL;
+        while (header->init_state.load(std::memory_order_acquire) != 2) {
+            if (monotonicNs() > deadline) {
+                logEvent("warning", "Inicialização do segmento de snapshot abandonada - refazendo", "main", getpid(), name);
+                initialize = true;
+                break;
+            }
+            sched_yield();
+        }
+    }
+    if (initialize) {
+        header->magic = SNAP_MAGIC;
+        header->size.store(initial, std::memory_order_relaxed);
+        for (int i = 0; i < SNAP_BUFFERS; i++) {
+            SnapshotBuffer& buffer = header->buffers[i];
+            buffer.offset = sizeof(SnapshotHeader) + (uint64_t)i * SNAP_INITIAL_CAPACITY;
+            buffer.capacity = SNAP_INITIAL_CAPACITY;
+            buffer.length = 0;
+            buffer.generation = 0;
+        }
+        header->published.store(0, std::memory_order_relaxed);
+        header->init_state.store(2, std::memory_order_release);
+    }
+    
+    if (header->magic != SNAP_MAGIC) {
+        logEvent("error", "Segmento de snapshot incompatível", "main", getpid(), name);
+        munmap(snapshot_map.base, snapshot_map.mapped);
+        close(fd);
+        snapshot_map = SnapshotMapping();
+        return nullptr;
+    }
+    
+    logEvent("shm", "Segmento de snapshot aberto", "main", getpid(),
+             "name=" + name + " size=" + std::to_string(header->size.load()));
+    return header;
+}
+
+// Função para desmapear o segmento de snapshot deste processo
+void closeSnapshot() {
+    if (snapshot_map.base == nullptr) {
+        return;
+    }
+    munmap(snapshot_map.base, snapshot_map.mapped);
+    close(snapshot_map.fd);
+    snapshot_map = SnapshotMapping();
+}
+
+// Checksum FNV-1a de 64 bits por palavra, barato o bastante para blobs de megabytes
+uint64_t snapshotChecksum(const char* data, size_t length) {
+    uint64_t hash = 14695981039346656037ULL;
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= length; i += sizeof(uint64_t)) {
+        uint64_t word;
+        memcpy(&word, data + i, sizeof(word));
+        hash = (hash ^ word) * 1099511628211ULL;
+    }
+    for (; i < length; i++) {
+        hash = (hash ^ (unsigned char)data[i]) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+// Um escritor por vez; a vaga de um escritor que morreu é retomada
+bool snapshotAcquireWriter(SnapshotHeader* header) {
+    int owner = 0;
+    if (header->writer_pid.compare_exchange_strong(owner, getpid(), std::memory_order_acquire)) {
+        return true;
+    }
+    if (kill(owner, 0) == -1 && errno == ESRCH &&
+        header->writer_pid.compare_exchange_strong(owner, getpid(), std::memory_order_acquire)) {
+        logEvent("recovery", "Escritor do snapshot terminou durante a publicação - vaga retomada",
+                 "writer", getpid(), "owner_pid=" + std::to_string(owner));
+        return true;
+    }
+    logEvent("warning", "Outro processo está publicando o snapshot", "writer", getpid(),
+             "owner_pid=" + std::to_string(owner));
+    return false;
+}
+
+// Escolhe um buffer inativo sem leitores; com três buffers, um leitor lento
+// no snapshot anterior não bloqueia o escritor. Retorna -1 após SNAP_WAIT_NS
+int snapshotPickBuffer(SnapshotHeader* header) {
+    uint32_t published = header->published.load(std::memory_order_relaxed);
+    uint64_t deadline = 0;
+    
+    while (true) {
+        for (int i = 0; i < SNAP_BUFFERS; i++) {
+            if ((uint32_t)i != published && header->buffers[i].readers.load() == 0) {
+                if (deadline != 0) {
+                    header->pinned_waits.fetch_add(1, std::memory_order_relaxed);
+                }
+                return i;
+            }
+        }
+        if (deadline == 0) {
+            deadline = monotonicNs() + SNAP_WAIT_NS;
+        } else if (monotonicNs() > deadline) {
+            return -1;
+        }
+        sched_yield();
+    }
+}
+
+// Função para publicar um blob como novo snapshot (sem lock do segmento)
+void snapshotPublish(const std::string& blob) {
+    SnapshotHeader* header = openSnapshot();
+    if (header == nullptr || !snapshotAcquireWriter(header)) {
+        return;
+    }
+    
+    static SpanOp& publish_span = spanOp("shm.snap_publish");
+    uint64_t span = spanStart();
+    
+    int index = snapshotPickBuffer(header);
+    if (index < 0) {
+        header->writer_pid.store(0, std::memory_order_release);
+        logEvent("warning", "Buffers inativos do snapshot fixados por leitores - publicação cancelada",
+                 "writer", getpid());
+        return;
+    }
+    
+    // Blob maior que o buffer: realoca o buffer no fim do segmento, que cresce.
+    // Leitores atrasados só fixam o buffer publicado, nunca este
+    SnapshotBuffer* buffer = &header->buffers[index];
+    if (blob.size() > buffer->capacity) {
+        uint64_t capacity = std::max<uint64_t>(blob.size(), buffer->capacity * 2);
+        uint64_t offset = header->size.load(std::memory_order_relaxed);
+        if (ftruncate(snapshot_map.fd, offset + capacity) == -1 || !snapshotMapTo(offset + capacity)) {
+            logEvent("error", "Erro ao aumentar o segmento de snapshot: " +
+                     std::string(strerror(errno)), "writer", getpid(), std::to_string(offset + capacity));
+            snapshotHeader()->writer_pid.store(0, std::memory_order_release);
+            return;
+        }
+        header = snapshotHeader();
+        buffer = &header->buffers[index];
+        buffer->offset = offset;
+        buffer->capacity = capacity;
+        header->size.store(offset + capacity, std::memory_order_relaxed);
+        logEvent("shm", "Buffer de snapshot realocado", "writer", getpid(),
+                 "buffer=" + std::to_string(index) + " capacity=" + std::to_string(capacity) +
+                 " segment_size=" + std::to_string(offset + capacity));
+    }
+    
+    char* data = snapshot_map.base + buffer->offset;
+    memcpy(data, blob.data(), blob.size());
+    buffer->length = blob.size();
+    buffer->checksum = snapshotChecksum(data, blob.size());
+    buffer->writer = getpid();
+    buffer->published_ns = monotonicNs();
+    buffer->generation = header->generation.load(std::memory_order_relaxed) + 1;
+    header->generation.store(buffer->generation, std::memory_order_relaxed);
+    
+    // Troca o buffer publicado; leitores novos passam a fixar este
+    header->published.store(index);
+    header->writer_pid.store(0, std::memory_order_release);
+    spanEnd(publish_span, span);
+    
+    LOG_EVENT(LOG_INFO, "write", "Snapshot publicado", "writer", getpid(),
+              "generation=" + std::to_string(buffer->generation) + " bytes=" + std::to_string(blob.size()) +
+              " buffer=" + std::to_string(index));
+}
+
+// Função para ler o snapshot mais recente sem lock: fixa o buffer, copia e solta
+void snapshotRead() {
+    SnapshotHeader* header = openSnapshot();
+    if (header == nullptr) {
+        return;
+    }
+    
+    static SpanOp& read_span = spanOp("shm.snap_read");
+    uint64_t span = spanStart();
+    
+    // Fixa o buffer publicado; se published mudou entre a leitura e o incremento,
+    // o escritor pode ter escolhido este buffer: solta e tenta de novo
+    uint32_t index;
+    unsigned retries = 0;
+    while (true) {
+        index = header->published.load();
+        header->buffers[index].readers.fetch_add(1);
+        if (header->published.load() == index) {
+            break;
+        }
+        header->buffers[index].readers.fetch_sub(1);
+        retries++;
+    }
+    
+    SnapshotBuffer* buffer = &header->buffers[index];
+    uint64_t generation = buffer->generation;
+    uint64_t length = buffer->length;
+    bool mapped = generation != 0 && snapshotMapTo(buffer->offset + length);
+    header = snapshotHeader();
+    buffer = &header->buffers[index];
+    
+    std::string preview;
+    bool intact = true;
+    if (mapped) {
+        const char* data = snapshot_map.base + buffer->offset;
+        intact = snapshotChecksum(data, length) == buffer->checksum;
+        preview.assign(data, std::min<uint64_t>(length, 64));
+    }
+    buffer->readers.fetch_sub(1);
+    spanEnd(read_span, span);
+    
+    if (generation == 0) {
+        logEvent("read", "Nenhum snapshot publicado", "reader", getpid());
+        return;
+    }
+    if (!mapped) {
+        logEvent("error", "Snapshot fora da área mapeada", "reader", getpid());
+        return;
+    }
+    if (!intact) {
+        logEvent("error", "Checksum do snapshot não confere", "reader", getpid(),
+                 "generation=" + std::to_string(generation));
+        return;
+    }
+    LOG_EVENT(LOG_INFO, "read", "Snapshot lido (generation=" + std::to_string(generation) +
+              " bytes=" + std::to_string(length) + " buffer=" + std::to_string(index) +
+              " retries=" + std::to_string(retries) + ")", "reader", getpid(), preview);
+}
+
+// Aloca um bloco da arena para length bytes; retorna o offset ou 0 se não houver espaço
+uint32_t slabAlloc(SlabArena* arena, size_t length) {
+    int size_class = 0;
+    while (size_class < SLAB_CLASS_COUNT &&
+           slabClassSize(size_class) - sizeof(SlabBlockHeader) < length) {
+        size_class++;
+    }
+    if (size_class == SLAB_CLASS_COUNT) {
+        return 0;
+    }
+    
+    uint32_t block_size = slabClassSize(size_class);
+    uint32_t offset = arena->free_head[size_class];
+    SlabBlockHeader* header;
+    
+    if (offset != 0) {
+        // Reutiliza o bloco do topo da lista livre da classe
+        header = reinterpret_cast<SlabBlockHeader*>(arena->storage + offset);
+        arena->free_head[size_class] = header->next_free;
+        arena->free_count[size_class]--;
+    } else {
+        // Corta um bloco novo da área nunca alocada (offset 0 fica reservado)
+        if (arena->bump == 0) {
+            arena->bump = SLAB_MIN_BLOCK;
+        }
+        if (arena->bump + block_size > SLAB_ARENA_SIZE) {
+            return 0;
+        }
+        offset = arena->bump;
+        arena->bump += block_size;
+        header = reinterpret_cast<SlabBlockHeader*>(arena->storage + offset);
+        header->magic = SLAB_BLOCK_MAGIC;
+        header->size_class = (uint16_t)size_class;
+    }
+    
+    header->allocated = 1;
+    header->length = (uint32_t)length;
+    header->next_free = 0;
+    arena->live_blocks++;
+    arena->live_block_bytes += block_size;
+    arena->live_requested_bytes += length;
+    return offset;
+}
+
+// Valida um offset recebido do usuário e retorna o bloco alocado correspondente
+SlabBlockHeader* slabBlock(SlabArena* arena, uint32_t offset) {
+    if (offset == 0 || offset % SLAB_MIN_BLOCK != 0 || offset >= arena->bump) {
+        return nullptr;
+    }
+    SlabBlockHeader* header = reinterpret_cast<SlabBlockHeader*>(arena->storage + offset);
+    if (header->magic != SLAB_BLOCK_MAGIC || !header->allocated ||
+        header->size_class >= SLAB_CLASS_COUNT) {
+        return nullptr;
+    }
+    return header;
+}
+
+void slabFree(SlabArena* arena, uint32_t offset, SlabBlockHeader* header) {
+    int size_class = header->size_class;
+    arena->live_blocks--;
+    arena->live_block_bytes -= slabClassSize(size_class);
+    arena->live_requested_bytes -= header->length;
+    
+    header->allocated = 0;
+    header->length = 0;
+    header->next_free = arena->free_head[size_class];
+    arena->free_head[size_class] = offset;
+    arena->free_count[size_class]++;
+}
+
+// Função para armazenar uma mensagem de tamanho variável na arena
+void allocWrite(const std::string& message) {
+    if (!shm_state.attached) {
+        logEvent("error", "Não anexado à memória compartilhada", "writer", getpid());
+        return;
+    }
+    
+    SlabArena* arena = &shm_state.segment->arena;
+    
+    segment_lock();
+    uint32_t offset = slabAlloc(arena, message.length());
+    if (offset != 0) {
+        memcpy(arena->storage + offset + sizeof(SlabBlockHeader), message.data(), message.length());
+    }
+    segment_unlock();
+    
+    if (offset == 0) {
+        logEvent("error", "Sem espaço na arena para a mensagem", "writer", getpid(),
+                 "bytes=" + std::to_string(message.length()) + " max=" +
+                 std::to_string(slabClassSize(SLAB_CLASS_COUNT - 1) - sizeof(SlabBlockHeader)));
+        return;
+    }
+    
+    logEvent("alloc", "Mensagem armazenada na arena", "writer", getpid(),
+             "offset=" + std::to_string(offset) + " bytes=" + std::to_string(message.length()));
+    displayMemoryState(shm_state.segment, shm_state.shm_id, shm_state.sem_id);
+}
+
+// Função para ler uma mensagem armazenada na arena
+void allocRead(uint32_t offset) {
+    if (!shm_state.attached) {
+        logEvent("error", "Não anexado à memória compartilhada", "reader", getpid());
+        return;
+    }
+    
+    SlabArena* arena = &shm_state.segment->arena;
+    std::string message;
+    
+    segment_lock();
+    SlabBlockHeader* header = slabBlock(arena, offset);
+    if (header != nullptr) {
+        message.assign(arena->storage + offset + sizeof(SlabBlockHeader), header->length);
+    }
+    segment_unlock();
+    
+    if (header == nullptr) {
+        logEvent("error", "Offset inválido ou bloco não alocado", "reader", getpid(), std::to_string(offset));
+        return;
+    }
+    logEvent("read", "Mensagem lida da arena (offset=" + std::to_string(offset) + ")", "reader", getpid(), message);
+}
+
+// Função para liberar um bloco da arena
+void freeBlock(uint32_t offset) {
+    if (!shm_state.attached) {
+        logEvent("error", "Não anexado à memória compartilhada", "main", getpid());
+        return;
+    }
+    
+    SlabArena* arena = &shm_state.segment->arena;
+    
+    segment_lock();
+    SlabBlockHeader* header = slabBlock(arena, offset);
+    if (header != nullptr) {
+        slabFree(arena, offset, header);
+    }
+    segment_unlock();
+    
+    if (header == nullptr) {
+        logEvent("error", "Offset inválido ou bloco já liberado", "main", getpid(), std::to_string(offset));
+        return;
+    }
+    
+    logEvent("alloc", "Bloco liberado", "main", getpid(), "offset=" + std::to_string(offset));
+    displayMemoryState(shm_state.segment, shm_state.shm_id, shm_state.sem_id);
+}
+
+// Função para limpar recursos
+void cleanupMemory() {
+    if (!shm_state.memory_created) {
+        logEvent("warning", "Memória não foi criada", "cleaner", getpid());
+        return;
+    }
+    
+    logEvent("operation", "Iniciando limpeza de recursos", "cleaner", getpid());
+    
+    sem_lock(shm_state.sem_id);
+    
+    // Remover memória compartilhada
+    bool removed;
+    if (segment_config.backend == BACKEND_POSIX) {
+        removed = shm_unlink(segment_config.name.c_str()) == 0;
+        close(shm_state.shm_id);
+    } else {
+        removed = shmctl(shm_state.shm_id, IPC_RMID, NULL) == 0;
+    }
+    
+    closeSnapshot();
+    if (shm_unlink(snapshotName().c_str()) == 0) {
+        logEvent("shm", "Segmento de snapshot removido", "cleaner", getpid());
+    }
+    
+    if (removed) {
+        logEvent("shm", "Memória compartilhada removida", "cleaner", getpid());
+        shm_state.memory_created = false;
+    } else {
+        logEvent("error", "Erro ao remover memória: " + 
+                 std::string(strerror(errno)), "cleaner", getpid());
     }
     
     // Remover semáforo
@@ -294,7 +2068,9 @@ void cleanupMemory() {
     sem_unlock(shm_state.sem_id);
     
     shm_state.attached = false;
+    shm_state.segment = nullptr;
     shm_state.shared_data = nullptr;
+    shm_state.broadcast_reader = -1;
 }
 
 // Função para desanexar da memória
@@ -304,9 +2080,19 @@ void detachFromMemory() {
         return;
     }
     
-    if (shmdt(shm_state.shared_data) == 0) {
+    // Libera a entrada na tabela de leitores para não travar os escritores
+    if (shm_state.broadcast_reader >= 0) {
+        broadcastLeave();
+    }
+    closeSnapshot();
+    
+    int rc = segment_config.backend == BACKEND_POSIX
+                 ? munmap(shm_state.segment, segment_config.mapped_size)
+                 : shmdt(shm_state.segment);
+    if (rc == 0) {
         logEvent("shm", "Memória compartilhada desanexada", "main", getpid());
         shm_state.attached = false;
+        shm_state.segment = nullptr;
         shm_state.shared_data = nullptr;
     } else {
         logEvent("error", "Erro ao desanexar memória: " + 
@@ -327,6 +2113,7 @@ void resetSharedMemory() {
     // Resetar estado
     shm_state.shm_id = -1;
     shm_state.sem_id = -1;
+    shm_state.segment = nullptr;
     shm_state.shared_data = nullptr;
     shm_state.memory_created = false;
     shm_state.semaphore_created = false;
@@ -335,57 +2122,219 @@ void resetSharedMemory() {
     logEvent("system", "Estado da memória compartilhada resetado", "main", getpid());
 }
 
-// Função principal com controle por comandos
-int main() {
-    logEvent("system", "Shared Memory Manager iniciado - Aguardando comandos", "main", getpid());
-    logEvent("instruction", "Comandos disponíveis: create, attach, write <message>, read, detach, cleanup, reset, exit", "main", getpid());
+// Função para converter tamanhos como 4096, 64K, 256M ou 2G em bytes
+bool parseSize(const std::string& text, size_t& bytes) {
+    char* end = nullptr;
+    unsigned long long value = strtoull(text.c_str(), &end, 10);
+    if (end == text.c_str()) {
+        return false;
+    }
     
-    std::string command;
+    switch (*end) {
+        case '\0': break;
+        case 'k': case 'K': value <<= 10; break;
+        case 'm': case 'M': value <<= 20; break;
+        case 'g': case 'G': value <<= 30; break;
+        default: return false;
+    }
     
-    while (true) {
-        // Ler comando do stdin
-        if (!std::getline(std::cin, command)) {
-            break;
-        }
+    bytes = value;
+    return true;
+}
+
+// Função para processar as opções de linha de comando
+bool parseArguments(int argc, char* argv[]) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
         
-        // Processar comando
-        if (command == "create") {
-            createSharedMemory();
-        }
-        else if (command == "attach") {
-            attachToMemory();
-        }
-        else if (command.find("write ") == 0) {
-            if (command.length() > 6) {
-                std::string message = command.substr(6);
-                writeToMemory(message);
-            } else {
-                logEvent("error", "Comando write requer uma mensagem", "main", getpid());
+        if (arg == "--backend=sysv") {
+            segment_config.backend = BACKEND_SYSV;
+        } else if (arg == "--backend=posix") {
+            segment_config.backend = BACKEND_POSIX;
+        } else if (arg.find("--name=") == 0) {
+            segment_config.name = arg.substr(7);
+            if (segment_config.name.empty() || segment_config.name[0] != '/') {
+                segment_config.name = "/" + segment_config.name;
             }
+        } else if (arg.find("--size=") == 0) {
+            if (!parseSize(arg.substr(7), segment_config.size)) {
+                logEvent("error", "Tamanho inválido: " + arg.substr(7), "main", getpid());
+                return false;
+            }
+        } else if (arg == "--hugetlb") {
+            segment_config.hugetlb = true;
+        } else if (arg == "--populate") {
+            segment_config.populate = true;
+        } else {
+            logEvent("error", "Opção não reconhecida: " + arg, "main", getpid(),
+                     "uso: shared_memory [--backend=sysv|posix] [--name=/nome] [--size=64M] [--hugetlb] [--populate]");
+            return false;
         }
-        else if (command == "read") {
-            readFromMemory();
+    }
+    return true;
+}
+
+// Função para relatar eventos do loop de comandos (batch, repeat)
+void reportCommand(const std::string& type, const std::string& message, const std::string& data) {
+    logEvent(type, message, "main", getpid(), data);
+}
+
+// Função para executar um comando; false encerra o programa
+bool handleCommand(const std::string& command) {
+    if (command == "create") {
+        createSharedMemory();
+    }
+    else if (command == "attach") {
+        attachToMemory();
+    }
+    else if (command.find("write ") == 0) {
+        if (command.length() > 6) {
+            std::string message = command.substr(6);
+            writeToMemory(message);
+        } else {
+            logEvent("error", "Comando write requer uma mensagem", "main", getpid());
         }
-        else if (command == "detach") {
-            detachFromMemory();
+    }
+    else if (command.find("crash_write ") == 0) {
+        crashDuringWrite(command.substr(12));
+    }
+    else if (command == "read") {
+        readFromMemory();
+    }
+    else if (command == "wait_read" || command.find("wait_read ") == 0) {
+        int timeout_ms = command.length() > 10 ? atoi(command.substr(10).c_str()) : 0;
+        waitAndReadFromMemory(timeout_ms);
+    }
+    else if (command == "seq_read") {
+        seqReadFromMemory();
+    }
+    else if (command.find("seq_bench ") == 0) {
+        long iterations = atol(command.substr(10).c_str());
+        if (iterations > 0) {
+            benchmarkSeqRead(iterations);
+        } else {
+            logEvent("error", "Comando seq_bench requer um número de iterações", "reader", getpid());
         }
-        else if (command == "cleanup") {
-            cleanupMemory();
+    }
+    else if (command.find("lock_mode ") == 0) {
+        setLockMode(command.substr(10));
+    }
+    else if (command.find("lock_bench ") == 0) {
+        long iterations = atol(command.substr(11).c_str());
+        if (iterations > 0) {
+            benchmarkLock(iterations);
+        } else {
+            logEvent("error", "Comando lock_bench requer um número de iterações", "main", getpid());
         }
-        else if (command == "reset") {
-            resetSharedMemory();
+    }
+    else if (command.find("ring_write ") == 0) {
+        if (command.length() > 11) {
+            std::string message = command.substr(11);
+            ringWrite(message);
+        } else {
+            logEvent("error", "Comando ring_write requer uma mensagem", "main", getpid());
         }
-        else if (command == "exit") {
-            logEvent("system", "Encerrando Shared Memory Manager", "main", getpid());
-            break;
+    }
+    else if (command == "ring_read") {
+        ringRead();
+    }
+    else if (command == "bcast_join") {
+        broadcastJoin();
+    }
+    else if (command.find("bcast_write ") == 0) {
+        if (command.length() > 12) {
+            broadcastWrite(command.substr(12));
+        } else {
+            logEvent("error", "Comando bcast_write requer uma mensagem", "main", getpid());
         }
-        else if (!command.empty()) {
-            logEvent("error", "Comando não reconhecido: " + command, "main", getpid());
+    }
+    else if (command == "bcast_read") {
+        broadcastRead();
+    }
+    else if (command == "bcast_leave") {
+        broadcastLeave();
+    }
+    else if (command.find("snap_write ") == 0) {
+        if (command.length() > 11) {
+            snapshotPublish(command.substr(11));
+        } else {
+            logEvent("error", "Comando snap_write requer uma mensagem", "main", getpid());
         }
-        
-        // Pequena pausa
-        usleep(10000); // 10ms
     }
+    else if (command.find("snap_fill ") == 0) {
+        size_t bytes = 0;
+        if (parseSize(command.substr(10), bytes) && bytes > 0) {
+            // Blob sintético para medir publicação de estados de vários megabytes
+            static unsigned fill_count = 0;
+            snapshotPublish(std::string(bytes, (char)('a' + fill_count++ % 26)));
+        } else {
+            logEvent("error", "Comando snap_fill requer um tamanho (ex.: 4M)", "main", getpid());
+        }
+    }
+    else if (command == "snap_read") {
+        snapshotRead();
+    }
+    else if (command.find("alloc_write ") == 0) {
+        if (command.length() > 12) {
+            allocWrite(command.substr(12));
+        } else {
+            logEvent("error", "Comando alloc_write requer uma mensagem", "main", getpid());
+        }
+    }
+    else if (command.find("alloc_read ") == 0) {
+        allocRead((uint32_t)strtoul(command.substr(11).c_str(), nullptr, 10));
+    }
+    else if (command.find("free ") == 0) {
+        freeBlock((uint32_t)strtoul(command.substr(5).c_str(), nullptr, 10));
+    }
+    else if (command == "detach") {
+        detachFromMemory();
+    }
+    else if (command == "cleanup") {
+        cleanupMemory();
+    }
+    else if (command == "reset") {
+        resetSharedMemory();
+    }
+    else if (command == "loglevel" || command.find("loglevel ") == 0) {
+        logLevelCommand(command.substr(8));
+    }
+    else if (command == "topology") {
+        placementTopologyCommand("shared_memory");
+    }
+    else if (command == "stats" || command.find("stats ") == 0) {
+        spanCommand(command.substr(5), "shared_memory");
+    }
+    else if (command == "wait" || command.find("wait ") == 0) {
+        waitCommand(command.substr(4), "shared_memory");
+    }
+    else if (command == "exit") {
+        logEvent("system", "Encerrando Shared Memory Manager", "main", getpid());
+        return false;
+    }
+    else if (!command.empty()) {
+        logEvent("error", "Comando não reconhecido: " + command, "main", getpid());
+    }
+    return true;
+}
+
+// Função principal com controle por comandos
+int main(int argc, char* argv[]) {
+    logInit(argc, argv);
+    CommandRunner runner(handleCommand, reportCommand);
+    commandInit(argc, argv, runner);
+    spanInit(argc, argv);
+    placementInit(argc, argv, "main");
+    waitInit(argc, argv);
+    
+    if (!parseArguments(argc, argv)) {
+        return 1;
+    }
+    
+    logEvent("system", "Shared Memory Manager iniciado - Aguardando comandos", "main", getpid(), placementSummary());
+    logEvent("instruction", "Comandos disponíveis: create, attach, write <message>, read, wait_read [timeout_ms], seq_read, seq_bench <n>, ring_write <message>, ring_read, bcast_join, bcast_write <message>, bcast_read, bcast_leave, snap_write <message>, snap_fill <bytes>, snap_read, alloc_write <message>, alloc_read <offset>, free <offset>, lock_mode <futex|sysv|robust>, lock_bench <n>, crash_write <message>, detach, cleanup, reset, batch <arquivo>, repeat <n> <comando>, stats [on|off|reset], wait [block|spin|spin_yield|adaptive] [spin_us], topology, loglevel [categoria] [nível|sample <n>], exit", "main", getpid());
+    
+    runCommandLoop(runner);
     
     // Limpeza final
     if (shm_state.attached) {
@@ -9,74 +9,151 @@
 #include <string>
 #include <fcntl.h>
 #include <cerrno>
+#include "uring.h"
+#include "protocol.h"
+#include "log.h"
+#include "commands.h"
+#include "spans.h"
+#include "placement.h"
+#include "wait.h"
+#include <poll.h>
+#include <unordered_map>
+#include <cstdint>
 
 #define SOCKET_PATH "/tmp/demo_socket"
 #define BUFFER_SIZE 1024
-
-// Função para obter timestamp
-std::string getTimestamp() {
-    std::time_t now = std::time(nullptr);
-    std::tm* tm = std::localtime(&now);
-    
-    std::stringstream ss;
-    ss << std::put_time(tm, "%Y-%m-%d %H:%M:%S");
-    return ss.str();
-}
-
-// Função para escapar caracteres JSON
-std::string escapeJson(const std::string& s) {
-    std::stringstream o;
-    for (char c : s) {
-        switch (c) {
-            case '"':  o << "\\\""; break;
-            case '\\': o << "\\\\"; break;
-            case '\b': o << "\\b";  break;
-            case '\f': o << "\\f";  break;
-            case '\n': o << "\\n";  break;
-            case '\r': o << "\\r";  break;
-            case '\t': o << "\\t";  break;
-            default:
-                if ('\x00' <= c && c <= '\x1f') {
-                    o << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c);
-                } else {
-                    o << c;
-                }
-        }
-    }
-    return o.str();
-}
+#define URING_ENTRIES 8
+#define URING_SEND_BUFFER 65536   // buffer registrado para envios (engine io_uring)
+#define RESPONSE_TIMEOUT_MS 5000  // espera máxima sem progresso em send_many
+#define MAX_PIPELINE 1000000
 
 // Função para log em JSON
 void logEvent(const std::string& type, const std::string& message, 
               const std::string& component = "", const std::string& data = "") {
-    
-    std::cout << "{";
-    std::cout << "\"timestamp\": \"" << getTimestamp() << "\",";
-    std::cout << "\"type\": \"" << type << "\",";
-    std::cout << "\"component\": \"" << component << "\",";
-    std::cout << "\"message\": \"" << escapeJson(message) << "\"";
-    
+    if (!logAccept(type)) {
+        return;
+    }
+    LogLine& line = logBegin(type);
+    logString(line, "component", component);
+    logString(line, "message", message);
     if (!data.empty()) {
-        std::cout << ",\"data\": \"" << escapeJson(data) << "\"";
+        logString(line, "data", data);
     }
-    
-    std::cout << "}" << std::endl;
-    std::cout.flush(); // Garante output imediato
+    logEnd(line);
 }
 
+// Requisição enviada aguardando resposta
+struct PendingRequest {
+    uint64_t sent_ns;
+    bool pipelined;         // parte de um send_many (resposta resumida, não registrada uma a uma)
+};
+
 // Estrutura para gerenciar o estado do cliente
 struct ClientState {
     int sockfd;
     bool socket_created;
     bool connected;
     std::string server_path;
+    bool use_uring;             // engine io_uring ativo
+    UringQueue ring;
+    char* send_buffer;          // região registrada no anel
+    uint64_t next_request_id;
+    std::unordered_map<uint64_t, PendingRequest> pending;
+    std::string inbuf;          // bytes recebidos ainda não reunidos em quadros
     
     ClientState() : sockfd(-1), socket_created(false), 
-                   connected(false), server_path(SOCKET_PATH) {}
+                   connected(false), server_path(SOCKET_PATH),
+                   use_uring(false), send_buffer(nullptr), next_request_id(1) {}
 };
 
 ClientState client_state;
 
+// Função para obter tempo monotônico em nanossegundos
+uint64_t monotonicNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// Função para criar o anel io_uring e registrar o buffer de envio
+bool initUring() {
+    if (!uringInit(client_state.ring, URING_ENTRIES)) {
+        return false;
+    }
+    
+    void* buffer = mmap(NULL, URING_SEND_BUFFER, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (buffer == MAP_FAILED) {
+        uringClose(client_state.ring);
+        return false;
+    }
+    placementBindMemory(buffer, URING_SEND_BUFFER, "client");
+    
+    struct iovec iov;
+    iov.iov_base = buffer;
+    iov.iov_len = URING_SEND_BUFFER;
+    if (!uringRegisterBuffers(client_state.ring, &iov, 1)) {
+        int saved = errno;
+        munmap(buffer, URING_SEND_BUFFER);
+        uringClose(client_state.ring);
+        errno = saved;
+        return false;
+    }
+    
+    client_state.send_buffer = static_cast<char*>(buffer);
+    return true;
+}
+
+// Função para submeter a SQE preparada e aguardar sua conclusão na mesma syscall.
+// Retorna o resultado no formato de read/write (-1 com errno em erro).
+ssize_t uringRun() {
+    if (uringSubmit(client_state.ring, 1) < 0) {
+        return -1;
+    }
+    
+    struct io_uring_cqe* cqe = uringPeekCqe(client_state.ring);
+    if (!cqe) {
+        errno = EIO;
+        return -1;
+    }
+    int res = cqe->res;
+    uringCqeSeen(client_state.ring);
+    
+    if (res < 0) {
+        errno = -res;
+        return -1;
+    }
+    return res;
+}
+
+// Envio via io_uring: mensagens que cabem no buffer registrado usam WRITE_FIXED
+ssize_t uringWrite(const char* data, size_t length) {
+    struct io_uring_sqe* sqe = uringGetSqe(client_state.ring);
+    sqe->fd = client_state.sockfd;
+    if (length <= URING_SEND_BUFFER) {
+        memcpy(client_state.send_buffer, data, length);
+        sqe->opcode = IORING_OP_WRITE_FIXED;
+        sqe->addr = (uint64_t)(uintptr_t)client_state.send_buffer;
+        sqe->buf_index = 0;
+    } else {
+        sqe->opcode = IORING_OP_WRITE;
+        sqe->addr = (uint64_t)(uintptr_t)data;
+    }
+    sqe->len = length;
+    return uringRun();
+}
+
+// Recepção via io_uring
+ssize_t uringRecv(char* buffer, size_t size) {
+    struct io_uring_sqe* sqe = uringGetSqe(client_state.ring);
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = client_state.sockfd;
+    sqe->addr = (uint64_t)(uintptr_t)buffer;
+    sqe->len = size;
+    sqe->msg_flags = MSG_DONTWAIT;
+    return uringRun();
+}
+
 // Função para criar socket
 void createSocket() {
     if (client_state.socket_created) {
@@ -117,10 +194,139 @@ void connectToServer() {
         return;
     }
     
+    // Socket não-bloqueante: receive lê só o que já chegou e os envios
+    // esperam com poll quando o buffer do kernel enche
+    int flags = fcntl(client_state.sockfd, F_GETFL, 0);
+    fcntl(client_state.sockfd, F_SETFL, flags | O_NONBLOCK);
+    
     client_state.connected = true;
+    client_state.inbuf.clear();
+    client_state.pending.clear();
     logEvent("connection", "Conectado ao servidor", "client", client_state.server_path);
 }
 
+// Função para escrever todo o buffer, aguardando com poll se o socket encher
+bool writeAll(const char* data, size_t length) {
+    static SpanOp& write_span = spanOp("socket.write");
+    static SpanOp& writable_span = spanOp("socket.wait_writable");
+    size_t sent = 0;
+    while (sent < length) {
+        uint64_t span = spanStart();
+        ssize_t n = client_state.use_uring
+            ? uringWrite(data + sent, length - sent)
+            : write(client_state.sockfd, data + sent, length - sent);
+        spanEnd(write_span, span);
+        if (n > 0) {
+            sent += n;
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            struct pollfd pfd;
+            pfd.fd = client_state.sockfd;
+            pfd.events = POLLOUT;
+            span = spanStart();
+            poll(&pfd, 1, RESPONSE_TIMEOUT_MS);
+            spanEnd(writable_span, span);
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Resultado da leitura do que estiver disponível no socket
+enum DrainResult {
+    DRAIN_OK,
+    DRAIN_CLOSED,
+    DRAIN_ERROR
+};
+
+// Função para ler tudo que já chegou, sem bloquear, acumulando em inbuf
+DrainResult drainSocket(size_t& bytes) {
+    static SpanOp& read_span = spanOp("socket.read");
+    char buffer[BUFFER_SIZE * 16];
+    bytes = 0;
+    
+    while (true) {
+        uint64_t span = spanStart();
+        ssize_t n = client_state.use_uring
+            ? uringRecv(buffer, sizeof(buffer))
+            : read(client_state.sockfd, buffer, sizeof(buffer));
+        spanEnd(read_span, span);
+        if (n > 0) {
+            client_state.inbuf.append(buffer, n);
+            bytes += n;
+        } else if (n == 0) {
+            return DRAIN_CLOSED;
+        } else if (errno == EINTR) {
+            continue;
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return DRAIN_OK;
+        } else {
+            return DRAIN_ERROR;
+        }
+    }
+}
+
+// Totais das respostas casadas em uma chamada de handleResponses
+struct ResponseSummary {
+    uint64_t matched;
+    uint64_t unmatched;
+    double rtt_sum_us;
+    double rtt_max_us;
+    
+    ResponseSummary() : matched(0), unmatched(0), rtt_sum_us(0), rtt_max_us(0) {}
+};
+
+// Função para reunir os quadros completos de inbuf e casá-los com as
+// requisições pendentes. Retorna false se o fluxo estiver dessincronizado.
+bool handleResponses(ResponseSummary& summary) {
+    static WaitSite rtt_site("socket.rtt");
+    uint64_t now = monotonicNs();
+    size_t offset = 0;
+    
+    while (offset < client_state.inbuf.size()) {
+        FrameHeader header;
+        FrameStatus status = parseFrame(client_state.inbuf, offset, header);
+        if (status == FRAME_INCOMPLETE) {
+            break;
+        }
+        if (status == FRAME_INVALID) {
+            client_state.inbuf.clear();
+            return false;
+        }
+        
+        std::string response(client_state.inbuf.data() + offset + sizeof(FrameHeader), header.length);
+        offset += sizeof(FrameHeader) + header.length;
+        
+        std::unordered_map<uint64_t, PendingRequest>::iterator it = client_state.pending.find(header.request_id);
+        if (it == client_state.pending.end()) {
+            summary.unmatched++;
+            logEvent("warning", "Resposta sem requisição correspondente", "client",
+                     "id=" + std::to_string(header.request_id));
+            continue;
+        }
+        
+        double rtt_us = (now - it->second.sent_ns) / 1e3;
+        waitRecordWakeup(rtt_site, it->second.sent_ns);
+        summary.matched++;
+        summary.rtt_sum_us += rtt_us;
+        if (rtt_us > summary.rtt_max_us) {
+            summary.rtt_max_us = rtt_us;
+        }
+        if (!it->second.pipelined) {
+            std::stringstream ss;
+            ss << "id=" << header.request_id << " rtt_us=" << std::fixed << std::setprecision(1)
+               << rtt_us << " " << response;
+            LOG_EVENT(LOG_INFO, "receive", "Resposta recebida do servidor", "client", ss.str());
+        }
+        client_state.pending.erase(it);
+    }
+    
+    client_state.inbuf.erase(0, offset);
+    return true;
+}
+
 // Função para enviar mensagem
 void sendMessage(const std::string& message) {
     if (!client_state.connected) {
@@ -135,16 +341,102 @@ void sendMessage(const std::string& message) {
     
     logEvent("send", "Enviando mensagem para servidor", "client", message);
     
-    ssize_t bytes_sent = write(client_state.sockfd, message.c_str(), message.length());
-    if (bytes_sent < 0) {
+    uint64_t id = client_state.next_request_id++;
+    std::string frame;
+    appendFrame(frame, id, message.data(), message.size());
+    
+    PendingRequest request;
+    request.sent_ns = monotonicNs();
+    request.pipelined = false;
+    client_state.pending[id] = request;
+    
+    if (!writeAll(frame.data(), frame.size())) {
+        client_state.pending.erase(id);
         logEvent("error", "Erro ao enviar mensagem: " + std::string(strerror(errno)), "client");
     } else {
         logEvent("send", "Mensagem enviada com sucesso", "client", 
-                 "bytes=" + std::to_string(bytes_sent));
+                 "id=" + std::to_string(id) + " bytes=" + std::to_string(frame.size()));
     }
 }
 
-// Função para receber resposta
+// Função para enviar N requisições em pipeline (todas antes de ler qualquer
+// resposta) e aguardar todas as respostas, medindo vazão e RTT
+void sendMany(long count, const std::string& message) {
+    if (!client_state.connected) {
+        logEvent("error", "Não conectado ao servidor", "client");
+        return;
+    }
+    
+    if (count < 1 || count > MAX_PIPELINE || message.empty()) {
+        logEvent("error", "Uso: send_many <n> <mensagem> (1 <= n <= " + std::to_string(MAX_PIPELINE) + ")", "client");
+        return;
+    }
+    
+    logEvent("send", "Enviando requisições em pipeline", "client",
+             "count=" + std::to_string(count) + " bytes=" + std::to_string(message.size()));
+    
+    std::string batch;
+    batch.reserve(count * (sizeof(FrameHeader) + message.size()));
+    uint64_t start = monotonicNs();
+    PendingRequest request;
+    request.sent_ns = start;
+    request.pipelined = true;
+    for (long i = 0; i < count; i++) {
+        uint64_t id = client_state.next_request_id++;
+        appendFrame(batch, id, message.data(), message.size());
+        client_state.pending[id] = request;
+    }
+    
+    if (!writeAll(batch.data(), batch.size())) {
+        logEvent("error", "Erro ao enviar mensagem: " + std::string(strerror(errno)), "client");
+        return;
+    }
+    
+    // Aguardar as respostas até esgotar o tempo sem progresso
+    ResponseSummary summary;
+    while (summary.matched < (uint64_t)count) {
+        struct pollfd pfd;
+        pfd.fd = client_state.sockfd;
+        pfd.events = POLLIN;
+        int ready = waitPoll(&pfd, 1, RESPONSE_TIMEOUT_MS);
+        if (ready == 0) {
+            logEvent("error", "Tempo esgotado aguardando respostas", "client",
+                     "received=" + std::to_string(summary.matched) + " expected=" + std::to_string(count));
+            return;
+        }
+        if (ready < 0 && errno == EINTR) {
+            continue;
+        }
+        
+        size_t bytes;
+        DrainResult result = drainSocket(bytes);
+        if (!handleResponses(summary)) {
+            logEvent("error", "Quadro inválido recebido do servidor", "client");
+            return;
+        }
+        if (result == DRAIN_CLOSED) {
+            logEvent("connection", "Servidor fechou a conexão", "client");
+            client_state.connected = false;
+            return;
+        }
+        if (result == DRAIN_ERROR) {
+            logEvent("error", "Erro ao receber resposta: " + std::string(strerror(errno)), "client");
+            return;
+        }
+    }
+    
+    double elapsed_s = (monotonicNs() - start) / 1e9;
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(1)
+       << "count=" << count
+       << " elapsed_ms=" << elapsed_s * 1e3
+       << " requests_per_sec=" << count / elapsed_s
+       << " rtt_avg_us=" << summary.rtt_sum_us / summary.matched
+       << " rtt_max_us=" << summary.rtt_max_us;
+    logEvent("receive", "Respostas do pipeline recebidas", "client", ss.str());
+}
+
+// Função para receber resposta: lê o que já chegou e entrega os quadros completos
 void receiveResponse() {
     if (!client_state.connected) {
         logEvent("error", "Não conectado ao servidor", "client");
@@ -153,31 +445,61 @@ void receiveResponse() {
     
     logEvent("receive", "Aguardando resposta do servidor", "client");
     
-    // Configurar socket para não-bloqueante
-    int flags = fcntl(client_state.sockfd, F_GETFL, 0);
-    fcntl(client_state.sockfd, F_SETFL, flags | O_NONBLOCK);
+    // Com requisições pendentes, espera (como send_many) até RESPONSE_TIMEOUT_MS
+    // pela primeira resposta em vez de relatar que nada chegou ainda
+    ResponseSummary summary;
+    DrainResult result;
+    int saved_errno;
+    bool valid;
+    uint64_t deadline = monotonicNs() + RESPONSE_TIMEOUT_MS * 1000000ULL;
+    while (true) {
+        size_t bytes;
+        result = drainSocket(bytes);
+        saved_errno = errno;
+        valid = handleResponses(summary);
+        if (!valid || result != DRAIN_OK || summary.matched > 0 || summary.unmatched > 0 ||
+            client_state.pending.empty()) {
+            break;
+        }
+        
+        uint64_t now = monotonicNs();
+        if (now >= deadline) {
+            break;
+        }
+        struct pollfd pfd;
+        pfd.fd = client_state.sockfd;
+        pfd.events = POLLIN;
+        int ready = waitPoll(&pfd, 1, (int)((deadline - now + 999999ULL) / 1000000ULL));
+        if (ready == 0 || (ready < 0 && errno != EINTR)) {
+            break;
+        }
+    }
     
-    char buffer[BUFFER_SIZE];
-    ssize_t bytes_read = read(client_state.sockfd, buffer, BUFFER_SIZE - 1);
+    if (!valid) {
+        logEvent("error", "Quadro inválido recebido do servidor", "client");
+    } else if (summary.matched > 1) {
+        std::stringstream ss;
+        ss << std::fixed << std::setprecision(1)
+           << "responses=" << summary.matched
+           << " pending=" << client_state.pending.size()
+           << " rtt_avg_us=" << summary.rtt_sum_us / summary.matched
+           << " rtt_max_us=" << summary.rtt_max_us;
+        logEvent("receive", "Respostas recebidas do servidor", "client", ss.str());
+    }
     
-    if (bytes_read > 0) {
-        buffer[bytes_read] = '\0';
-        std::string response(buffer);
-        logEvent("receive", "Resposta recebida do servidor", "client", response);
-    } 
-    else if (bytes_read == 0) {
+    if (result == DRAIN_CLOSED) {
         logEvent("connection", "Servidor fechou a conexão", "client");
         client_state.connected = false;
+    } else if (result == DRAIN_ERROR) {
+        logEvent("error", "Erro ao receber resposta: " + std::string(strerror(saved_errno)), "client");
+    } else if (summary.matched == 0 && summary.unmatched == 0 && !client_state.pending.empty()) {
+        logEvent("error", "Tempo esgotado aguardando resposta", "client",
+                 "pending=" + std::to_string(client_state.pending.size()) +
+                 " timeout_ms=" + std::to_string(RESPONSE_TIMEOUT_MS));
+    } else if (summary.matched == 0 && summary.unmatched == 0) {
+        logEvent("receive", "Nenhuma resposta disponível no momento", "client",
+                 client_state.inbuf.empty() ? "" : "partial_bytes=" + std::to_string(client_state.inbuf.size()));
     }
-    else if (errno == EAGAIN || errno == EWOULDBLOCK) {
-        logEvent("receive", "Nenhuma resposta disponível no momento", "client");
-    }
-    else {
-        logEvent("error", "Erro ao receber resposta: " + std::string(strerror(errno)), "client");
-    }
-    
-    // Restaurar modo bloqueante
-    fcntl(client_state.sockfd, F_SETFL, flags);
 }
 
 // Função para fechar conexão
@@ -226,63 +548,105 @@ void setServerPath(const std::string& path) {
     logEvent("config", "Caminho do servidor configurado", "client", path);
 }
 
-// Função principal com controle por comandos
-int main() {
-    logEvent("system", "Cliente Socket iniciado - Aguardando comandos", "client");
-    logEvent("instruction", "Comandos disponíveis: create_socket, connect, send <message>, receive, close, reset, set_path <path>, exit", "client");
-    
-    std::string command;
-    
-    while (true) {
-        // Ler comando do stdin
-        if (!std::getline(std::cin, command)) {
-            break;
-        }
-        
-        // Processar comando
-        if (command == "create_socket") {
-            createSocket();
-        }
-        else if (command == "connect") {
-            connectToServer();
-        }
-        else if (command.find("send ") == 0) {
-            if (command.length() > 5) {
-                std::string message = command.substr(5);
-                sendMessage(message);
-            } else {
-                logEvent("error", "Comando send requer uma mensagem", "client");
-            }
-        }
-        else if (command == "receive") {
-            receiveResponse();
-        }
-        else if (command == "close") {
-            closeConnection();
-        }
-        else if (command == "reset") {
-            resetClient();
-        }
-        else if (command.find("set_path ") == 0) {
-            if (command.length() > 9) {
-                std::string path = command.substr(9);
-                setServerPath(path);
-            } else {
-                logEvent("error", "Comando set_path requer um caminho", "client");
-            }
+// Função para relatar eventos do loop de comandos (batch, repeat)
+void reportCommand(const std::string& type, const std::string& message, const std::string& data) {
+    logEvent(type, message, "client", data);
+}
+
+// Função para executar um comando; false encerra o programa
+bool handleCommand(const std::string& command) {
+    if (command == "create_socket") {
+        createSocket();
+    }
+    else if (command == "connect") {
+        connectToServer();
+    }
+    else if (command.find("send ") == 0) {
+        if (command.length() > 5) {
+            std::string message = command.substr(5);
+            sendMessage(message);
+        } else {
+            logEvent("error", "Comando send requer uma mensagem", "client");
         }
-        else if (command == "exit") {
-            logEvent("system", "Encerrando Cliente Socket", "client");
-            break;
+    }
+    else if (command.find("send_many ") == 0) {
+        std::istringstream iss(command.substr(10));
+        long count = 0;
+        std::string message;
+        iss >> count;
+        std::getline(iss >> std::ws, message);
+        sendMany(count, message);
+    }
+    else if (command == "receive") {
+        receiveResponse();
+    }
+    else if (command == "close") {
+        closeConnection();
+    }
+    else if (command == "reset") {
+        resetClient();
+    }
+    else if (command.find("set_path ") == 0) {
+        if (command.length() > 9) {
+            std::string path = command.substr(9);
+            setServerPath(path);
+        } else {
+            logEvent("error", "Comando set_path requer um caminho", "client");
         }
-        else if (!command.empty()) {
-            logEvent("error", "Comando não reconhecido: " + command, "client");
+    }
+    else if (command == "loglevel" || command.find("loglevel ") == 0) {
+        logLevelCommand(command.substr(8));
+    }
+    else if (command == "topology") {
+        placementTopologyCommand("client");
+    }
+    else if (command == "stats" || command.find("stats ") == 0) {
+        spanCommand(command.substr(5), "client");
+    }
+    else if (command == "wait" || command.find("wait ") == 0) {
+        waitCommand(command.substr(4), "client");
+    }
+    else if (command == "exit") {
+        logEvent("system", "Encerrando Cliente Socket", "client");
+        return false;
+    }
+    else if (!command.empty()) {
+        logEvent("error", "Comando não reconhecido: " + command, "client");
+    }
+    return true;
+}
+
+// Função principal com controle por comandos
+int main(int argc, char* argv[]) {
+    logInit(argc, argv);
+    CommandRunner runner(handleCommand, reportCommand);
+    commandInit(argc, argv, runner);
+    spanInit(argc, argv);
+    placementInit(argc, argv, "client");
+    waitInit(argc, argv);
+    
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--engine=uring" || arg == "--engine=syscall") {
+            client_state.use_uring = arg == "--engine=uring";
+        } else {
+            logEvent("error", "Opção não reconhecida: " + arg, "client", "uso: client [--engine=syscall|uring]");
+            return 1;
         }
-        
-        // Pequena pausa
-        usleep(10000); // 10ms
     }
     
+    // Sem io_uring no kernel, volta para read/write diretos
+    if (client_state.use_uring && !initUring()) {
+        logEvent("warning", "io_uring indisponível, usando read/write: " + std::string(strerror(errno)), "client");
+        client_state.use_uring = false;
+    }
+    
+    logEvent("system", "Cliente Socket iniciado - Aguardando comandos", "client",
+             std::string(client_state.use_uring ? "engine=uring" : "engine=syscall") + " " + placementSummary());
+    logEvent("instruction", "Comandos disponíveis: create_socket, connect, send <message>, send_many <n> <message>, receive, close, reset, set_path <path>, batch <arquivo>, repeat <n> <comando>, stats [on|off|reset], wait [block|spin|spin_yield|adaptive] [spin_us], topology, loglevel [categoria] [nível|sample <n>], exit", "client");
+    
+    runCommandLoop(runner);
+    
     // Limpeza final
     if (client_state.connected) {
         closeConnection();
@@ -0,0 +1,64 @@
+#ifndef SOCKETS_PROTOCOL_H
+#define SOCKETS_PROTOCOL_H
+
+// Enquadramento das mensagens entre cliente e servidor: cada requisição e
+// resposta leva um cabeçalho com tamanho e identificador, permitindo várias
+// requisições em voo (pipelining) na mesma conexão. Campos na ordem de bytes
+// do host, já que o socket é local (AF_UNIX).
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#define FRAME_MAGIC 0x46435049u              // "IPCF"
+#define MAX_FRAME_PAYLOAD (16 * 1024 * 1024)
+#define ECHO_PREFIX "ECHO: "                 // prefixo das respostas do servidor
+#define MAX_ECHO_PAYLOAD (MAX_FRAME_PAYLOAD - (sizeof(ECHO_PREFIX) - 1)) // maior requisição cuja resposta cabe em um quadro
+
+struct FrameHeader {
+    uint32_t magic;
+    uint32_t length;        // bytes de payload após o cabeçalho
+    uint64_t request_id;    // ecoado na resposta
+};
+
+static_assert(sizeof(FrameHeader) == 16, "FrameHeader deve ter 16 bytes");
+
+enum FrameStatus {
+    FRAME_INCOMPLETE,       // faltam bytes para o quadro inteiro
+    FRAME_READY,
+    FRAME_INVALID           // magic ou tamanho inválido: fluxo dessincronizado
+};
+
+// Função para acrescentar um quadro ao buffer de saída
+inline void appendFrame(std::string& out, uint64_t request_id, const char* data, size_t length) {
+    FrameHeader header;
+    header.magic = FRAME_MAGIC;
+    header.length = (uint32_t)length;
+    header.request_id = request_id;
+    out.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.append(data, length);
+}
+
+// Função para examinar o quadro que começa em offset; em FRAME_READY,
+// o payload ocupa [offset + sizeof(FrameHeader), offset + sizeof(FrameHeader) + header.length)
+inline FrameStatus parseFrame(const std::string& buffer, size_t offset, FrameHeader& header) {
+    size_t available = buffer.size() - offset;
+    if (available < sizeof(uint32_t)) {
+        // Verifica o prefixo do magic assim que possível
+        uint32_t magic = FRAME_MAGIC;
+        return memcmp(buffer.data() + offset, &magic, available) == 0 ? FRAME_INCOMPLETE : FRAME_INVALID;
+    }
+    if (available < sizeof(FrameHeader)) {
+        uint32_t magic;
+        memcpy(&magic, buffer.data() + offset, sizeof(magic));
+        return magic == FRAME_MAGIC ? FRAME_INCOMPLETE : FRAME_INVALID;
+    }
+
+    memcpy(&header, buffer.data() + offset, sizeof(header));
+    if (header.magic != FRAME_MAGIC || header.length > MAX_FRAME_PAYLOAD) {
+        return FRAME_INVALID;
+    }
+    return available - sizeof(FrameHeader) >= header.length ? FRAME_READY : FRAME_INCOMPLETE;
+}
+
+#endif
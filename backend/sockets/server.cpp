@@ -6,48 +6,957 @@
 #include <ctime>
 #include <sstream>
 #include <iomanip>
+#include <string>
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/eventfd.h>
+#include <poll.h>
+#include <unordered_map>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <cstdlib>
+#include "uring.h"
+#include "protocol.h"
+#include "log.h"
+#include "spans.h"
+#include "placement.h"
+#include "wait.h"
 
 #define SOCKET_PATH "/tmp/demo_socket"
 #define BUFFER_SIZE 1024
+#define MAX_EVENTS 256
+#define STATS_INTERVAL_MS 1000
+#define HANDOFF_CAPACITY 4096     // conexões pendentes por thread (potência de dois)
+#define CACHE_LINE_SIZE 64
+#define URING_ENTRIES 4096        // entradas do anel de submissão (engine io_uring)
+#define URING_BUFFER_SLOTS 4096   // fatias do buffer registrado, uma por conexão
+#define URING_SLOT_SIZE 4096
 
-// Função para obter timestamp
-std::string getTimestamp() {
-    std::time_t now = std::time(nullptr);
-    std::tm* tm = std::localtime(&now);
-    
-    std::stringstream ss;
-    ss << std::put_time(tm, "%Y-%m-%d %H:%M:%S");
-    return ss.str();
-}
-
-// Função para log em JSON
+// Função para log em JSON (a formatação é por thread; log.h serializa só o write)
 void logEvent(const std::string& type, const std::string& message, 
               const std::string& component = "", int client_id = -1, 
               const std::string& data = "") {
-    
-    std::cout << "{";
-    std::cout << "\"timestamp\": \"" << getTimestamp() << "\",";
-    std::cout << "\"type\": \"" << type << "\",";
-    std::cout << "\"component\": \"" << component << "\",";
+    if (!logAccept(type)) {
+        return;
+    }
+    LogLine& line = logBegin(type);
+    logString(line, "component", component);
     if (client_id != -1) {
-        std::cout << "\"client_id\": " << client_id << ",";
+        logInt(line, "client_id", client_id);
     }
-    std::cout << "\"message\": \"" << message << "\"";
-    
+    logString(line, "message", message);
     if (!data.empty()) {
-        std::cout << ",\"data\": \"" << data << "\"";
+        logString(line, "data", data);
+    }
+    logEnd(line);
+}
+
+// Formato detectado nos primeiros bytes da conexão
+enum Framing {
+    FRAMING_UNKNOWN,
+    FRAMING_FRAMES,     // quadros de protocol.h (requisições com ID, pipelining)
+    FRAMING_RAW         // bytes crus, ecoados como antes (ex.: nc/socat)
+};
+
+// Estado de uma conexão persistente
+struct Connection {
+    int fd;
+    int client_id;
+    std::string inbuf;      // bytes recebidos ainda não processados
+    std::string outbuf;     // bytes pendentes de envio
+    size_t out_offset;      // quanto de outbuf já foi enviado
+    bool want_write;        // EPOLLOUT registrado
+    Framing framing;
+    
+    // Engine io_uring
+    int buffer_slot;                 // fatia do buffer registrado (-1: usa read_buffer)
+    std::vector<char> read_buffer;   // usado quando não há fatia livre
+    std::string sending;             // bytes em voo; outbuf acumula o próximo lote
+    bool read_pending;
+    bool write_pending;
+    bool closing;
+    
+    Connection() : fd(-1), client_id(-1), out_offset(0), want_write(false),
+                   framing(FRAMING_UNKNOWN), buffer_slot(-1),
+                   read_pending(false), write_pending(false), closing(false) {}
+};
+
+// Fila SPSC sem lock para entregar conexões aceitas a uma thread de trabalho.
+// Preenchimento explícito (em vez de alignas) mantém head e tail em linhas de
+// cache diferentes também em objetos alocados com new no C++11.
+struct HandoffQueue {
+    char pad0[CACHE_LINE_SIZE];
+    std::atomic<size_t> head;   // avançado pela thread de trabalho
+    char pad1[CACHE_LINE_SIZE - sizeof(std::atomic<size_t>)];
+    std::atomic<size_t> tail;   // avançado pela thread de accept
+    char pad2[CACHE_LINE_SIZE - sizeof(std::atomic<size_t>)];
+    int fds[HANDOFF_CAPACITY];
+    
+    HandoffQueue() : head(0), tail(0) {}
+};
+
+static_assert((HANDOFF_CAPACITY & (HANDOFF_CAPACITY - 1)) == 0, "HANDOFF_CAPACITY deve ser potência de dois");
+
+bool handoffPush(HandoffQueue& queue, int fd) {
+    size_t tail = queue.tail.load(std::memory_order_relaxed);
+    if (tail - queue.head.load(std::memory_order_acquire) >= HANDOFF_CAPACITY) {
+        return false;
+    }
+    queue.fds[tail & (HANDOFF_CAPACITY - 1)] = fd;
+    queue.tail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+bool handoffPop(HandoffQueue& queue, int& fd) {
+    size_t head = queue.head.load(std::memory_order_relaxed);
+    if (head == queue.tail.load(std::memory_order_acquire)) {
+        return false;
     }
+    fd = queue.fds[head & (HANDOFF_CAPACITY - 1)];
+    queue.head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+// Estado de um loop de eventos (epoll) e seus contadores.
+// Os contadores atômicos são lidos pela thread que agrega as estatísticas.
+struct EventLoop {
+    int epoll_fd;
+    int listen_fd;              // -1 nas threads de trabalho
+    int wake_fd;                // eventfd sinalizado a cada conexão entregue (-1 sem threads)
+    HandoffQueue handoff;
+    std::unordered_map<int, Connection> connections;
+    std::atomic<uint64_t> total_requests;
+    std::atomic<uint64_t> open_connections;
+    std::atomic<uint64_t> syscalls;     // chamadas de sistema de E/S feitas pelo loop
+    
+    EventLoop() : epoll_fd(-1), listen_fd(-1), wake_fd(-1), total_requests(0), open_connections(0),
+                  syscalls(0) {}
+};
+
+// Amostra anterior usada para calcular as taxas agregadas
+struct StatsReporter {
+    uint64_t last_ns;
+    uint64_t reported_connections;
+    uint64_t last_syscalls;
+    std::vector<uint64_t> last_requests;   // total de requisições por loop na última amostra
     
-    std::cout << "}" << std::endl;
+    StatsReporter() : last_ns(0), reported_connections(0), last_syscalls(0) {}
+};
+
+std::atomic<int> client_counter(0);
+
+// Função para obter tempo monotônico em nanossegundos
+uint64_t monotonicNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// Função para configurar descritor como não-bloqueante
+bool setNonBlocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    return flags != -1 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) != -1;
+}
+
+// Função para atualizar os eventos de interesse da conexão
+void updateInterest(EventLoop& loop, Connection& conn, bool want_write) {
+    if (conn.want_write == want_write) {
+        return;
+    }
+    struct epoll_event ev;
+    ev.events = EPOLLIN | EPOLLRDHUP | (want_write ? EPOLLOUT : 0);
+    ev.data.fd = conn.fd;
+    epoll_ctl(loop.epoll_fd, EPOLL_CTL_MOD, conn.fd, &ev);
+    loop.syscalls.fetch_add(1, std::memory_order_relaxed);
+    conn.want_write = want_write;
+}
+
+// Função para fechar e remover uma conexão
+void closeClient(EventLoop& loop, int fd) {
+    std::unordered_map<int, Connection>::iterator it = loop.connections.find(fd);
+    if (it == loop.connections.end()) {
+        return;
+    }
+    int client_id = it->second.client_id;
+    epoll_ctl(loop.epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+    close(fd);
+    loop.syscalls.fetch_add(2, std::memory_order_relaxed);
+    loop.connections.erase(it);
+    loop.open_connections.fetch_sub(1, std::memory_order_relaxed);
+    logEvent("connection", "Conexão com cliente fechada", "server", client_id);
+}
+
+// Função para enviar o máximo possível do buffer de saída.
+// Retorna false se a conexão foi fechada por erro.
+bool flushOutput(EventLoop& loop, Connection& conn) {
+    static SpanOp& write_span = spanOp("socket.write");
+    while (conn.out_offset < conn.outbuf.size()) {
+        uint64_t span = spanStart();
+        ssize_t n = write(conn.fd, conn.outbuf.data() + conn.out_offset,
+                          conn.outbuf.size() - conn.out_offset);
+        spanEnd(write_span, span);
+        loop.syscalls.fetch_add(1, std::memory_order_relaxed);
+        if (n > 0) {
+            conn.out_offset += n;
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            // Escrita parcial: aguarda EPOLLOUT para continuar
+            updateInterest(loop, conn, true);
+            return true;
+        } else {
+            logEvent("error", "Erro ao enviar resposta: " + std::string(strerror(errno)), "server", conn.client_id);
+            closeClient(loop, conn.fd);
+            return false;
+        }
+    }
+    
+    conn.outbuf.clear();
+    conn.out_offset = 0;
+    updateInterest(loop, conn, false);
+    return true;
+}
+
+// Função para responder um quadro (echo com o mesmo request_id)
+void answerFrame(EventLoop& loop, Connection& conn, const FrameHeader& header, const char* payload) {
+    std::string message(payload, header.length);
+    LOG_EVENT(LOG_INFO, "receive", "Mensagem recebida do cliente", "server", conn.client_id,
+              "id=" + std::to_string(header.request_id) + " " + message);
+    
+    // A resposta com o prefixo precisa caber em um quadro; senão o cliente veria
+    // um quadro inválido. Responde com erro no mesmo request_id
+    if (header.length > MAX_ECHO_PAYLOAD) {
+        logEvent("error", "Mensagem grande demais para o echo", "server", conn.client_id,
+                 "id=" + std::to_string(header.request_id) + " bytes=" + std::to_string(header.length) +
+                 " max=" + std::to_string(MAX_ECHO_PAYLOAD));
+        std::string error = "ERRO: mensagem excede " + std::to_string(MAX_ECHO_PAYLOAD) + " bytes";
+        appendFrame(conn.outbuf, header.request_id, error.data(), error.size());
+        loop.total_requests.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    
+    std::string response = ECHO_PREFIX + message;
+    appendFrame(conn.outbuf, header.request_id, response.data(), response.size());
+    loop.total_requests.fetch_add(1, std::memory_order_relaxed);
+    
+    LOG_EVENT(LOG_INFO, "send", "Resposta enviada para cliente", "server", conn.client_id, response);
+}
+
+// Função para processar os bytes recebidos: responde todos os quadros
+// completos (várias requisições podem chegar na mesma leitura) e mantém
+// o restante em inbuf. Retorna false se o fluxo for inválido.
+bool processInput(EventLoop& loop, Connection& conn) {
+    if (conn.inbuf.empty()) {
+        return true;
+    }
+    
+    if (conn.framing == FRAMING_UNKNOWN) {
+        FrameHeader header;
+        FrameStatus status = parseFrame(conn.inbuf, 0, header);
+        if (status == FRAME_INCOMPLETE && conn.inbuf.size() < sizeof(uint32_t)) {
+            return true;
+        }
+        conn.framing = status == FRAME_INVALID ? FRAMING_RAW : FRAMING_FRAMES;
+    }
+    
+    if (conn.framing == FRAMING_RAW) {
+        LOG_EVENT(LOG_INFO, "receive", "Mensagem recebida do cliente", "server", conn.client_id, conn.inbuf);
+        
+        // Processar mensagem (echo)
+        std::string response = ECHO_PREFIX + conn.inbuf;
+        conn.inbuf.clear();
+        conn.outbuf += response;
+        loop.total_requests.fetch_add(1, std::memory_order_relaxed);
+        
+        LOG_EVENT(LOG_INFO, "send", "Resposta enviada para cliente", "server", conn.client_id, response);
+        return true;
+    }
+    
+    size_t offset = 0;
+    while (offset < conn.inbuf.size()) {
+        FrameHeader header;
+        FrameStatus status = parseFrame(conn.inbuf, offset, header);
+        if (status == FRAME_INCOMPLETE) {
+            break;
+        }
+        if (status == FRAME_INVALID) {
+            logEvent("error", "Quadro inválido recebido, encerrando conexão", "server", conn.client_id);
+            return false;
+        }
+        answerFrame(loop, conn, header, conn.inbuf.data() + offset + sizeof(FrameHeader));
+        offset += sizeof(FrameHeader) + header.length;
+    }
+    conn.inbuf.erase(0, offset);
+    return true;
 }
 
-int main() {
-    int server_fd, client_fd;
-    struct sockaddr_un server_addr, client_addr;
-    socklen_t client_len = sizeof(client_addr);
+// Função para ler tudo que estiver disponível na conexão
+void handleReadable(EventLoop& loop, Connection& conn) {
+    static SpanOp& read_span = spanOp("socket.read");
     char buffer[BUFFER_SIZE];
     
-    logEvent("system", "Servidor iniciando", "server");
+    while (true) {
+        uint64_t span = spanStart();
+        ssize_t bytes_read = read(conn.fd, buffer, sizeof(buffer));
+        spanEnd(read_span, span);
+        loop.syscalls.fetch_add(1, std::memory_order_relaxed);
+        if (bytes_read > 0) {
+            conn.inbuf.append(buffer, bytes_read);
+        } else if (bytes_read == 0) {
+            // flushOutput fecha a conexão (e libera conn) quando a escrita falha
+            int fd = conn.fd;
+            if (processInput(loop, conn) && !flushOutput(loop, conn)) {
+                return;
+            }
+            closeClient(loop, fd);
+            return;
+        } else if (errno == EINTR) {
+            continue;
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            break;
+        } else {
+            logEvent("error", "Erro ao ler do cliente: " + std::string(strerror(errno)), "server", conn.client_id);
+            closeClient(loop, conn.fd);
+            return;
+        }
+    }
+    
+    if (!processInput(loop, conn)) {
+        closeClient(loop, conn.fd);
+        return;
+    }
+    flushOutput(loop, conn);
+}
+
+// Função para registrar uma nova conexão no loop
+void addClient(EventLoop& loop, int client_fd) {
+    if (!setNonBlocking(client_fd)) {
+        logEvent("error", "Erro ao configurar conexão não-bloqueante", "server");
+        close(client_fd);
+        return;
+    }
+    
+    Connection& conn = loop.connections[client_fd];
+    conn.fd = client_fd;
+    conn.client_id = ++client_counter;
+    
+    struct epoll_event ev;
+    ev.events = EPOLLIN | EPOLLRDHUP;
+    ev.data.fd = client_fd;
+    if (epoll_ctl(loop.epoll_fd, EPOLL_CTL_ADD, client_fd, &ev) == -1) {
+        logEvent("error", "Erro ao registrar conexão no epoll", "server", conn.client_id);
+        loop.connections.erase(client_fd);
+        close(client_fd);
+        return;
+    }
+    
+    loop.open_connections.fetch_add(1, std::memory_order_relaxed);
+    loop.syscalls.fetch_add(3, std::memory_order_relaxed);   // fcntl x2 + epoll_ctl
+    logEvent("connection", "Cliente conectado", "server", conn.client_id);
+}
+
+// Função para aceitar todas as conexões pendentes
+void acceptClients(EventLoop& loop) {
+    while (true) {
+        int client_fd = accept(loop.listen_fd, NULL, NULL);
+        loop.syscalls.fetch_add(1, std::memory_order_relaxed);
+        if (client_fd == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                logEvent("error", "Erro ao aceitar conexão: " + std::string(strerror(errno)), "server");
+            }
+            return;
+        }
+        addClient(loop, client_fd);
+    }
+}
+
+// Função para emitir número de conexões e requisições por segundo,
+// somando os contadores de todos os loops
+void reportStats(const std::vector<EventLoop*>& loops, StatsReporter& reporter, uint64_t now) {
+    double seconds = (now - reporter.last_ns) / 1e9;
+    reporter.last_requests.resize(loops.size(), 0);
+    
+    uint64_t connections = 0;
+    uint64_t requests = 0;
+    uint64_t total = 0;
+    uint64_t syscalls = 0;
+    std::stringstream per_thread;
+    per_thread << std::fixed << std::setprecision(1);
+    
+    for (size_t i = 0; i < loops.size(); i++) {
+        uint64_t loop_total = loops[i]->total_requests.load(std::memory_order_relaxed);
+        uint64_t delta = loop_total - reporter.last_requests[i];
+        reporter.last_requests[i] = loop_total;
+        connections += loops[i]->open_connections.load(std::memory_order_relaxed);
+        requests += delta;
+        total += loop_total;
+        syscalls += loops[i]->syscalls.load(std::memory_order_relaxed);
+        per_thread << (i ? "," : "") << delta / seconds;
+    }
+    
+    if (requests > 0 || connections != reporter.reported_connections) {
+        std::stringstream ss;
+        ss << "connections=" << connections
+           << " requests_per_sec=" << std::fixed << std::setprecision(1) << requests / seconds
+           << " total_requests=" << total;
+        if (requests > 0) {
+            ss << " syscalls_per_request=" << std::setprecision(2)
+               << (double)(syscalls - reporter.last_syscalls) / requests;
+        }
+        if (loops.size() > 1) {
+            ss << " threads=" << loops.size() << " per_thread_rps=" << per_thread.str();
+        }
+        logEvent("stats", "Estatísticas do servidor", "server", -1, ss.str());
+        reporter.reported_connections = connections;
+    }
+    reporter.last_syscalls = syscalls;
+    reporter.last_ns = now;
+}
+
+// Função para registrar as conexões entregues pela thread de accept
+void drainHandoff(EventLoop& loop) {
+    uint64_t signals;
+    while (read(loop.wake_fd, &signals, sizeof(signals)) > 0) {
+    }
+    
+    int client_fd;
+    while (handoffPop(loop.handoff, client_fd)) {
+        addClient(loop, client_fd);
+    }
+}
+
+// Loop principal de eventos; reporter é nulo quando outra thread agrega as estatísticas
+void runEventLoop(EventLoop& loop, StatsReporter* reporter) {
+    struct epoll_event events[MAX_EVENTS];
+    std::vector<EventLoop*> self(1, &loop);
+    if (reporter) {
+        reporter->last_ns = monotonicNs();
+    }
+    
+    while (true) {
+        int n = waitEpoll(loop.epoll_fd, events, MAX_EVENTS, reporter ? STATS_INTERVAL_MS : -1);
+        loop.syscalls.fetch_add(1, std::memory_order_relaxed);
+        if (n == -1 && errno != EINTR) {
+            logEvent("error", "Erro no epoll_wait: " + std::string(strerror(errno)), "server");
+            return;
+        }
+        
+        for (int i = 0; i < n; i++) {
+            int fd = events[i].data.fd;
+            if (fd == loop.listen_fd) {
+                acceptClients(loop);
+                continue;
+            }
+            if (fd == loop.wake_fd) {
+                drainHandoff(loop);
+                continue;
+            }
+            
+            std::unordered_map<int, Connection>::iterator it = loop.connections.find(fd);
+            if (it == loop.connections.end()) {
+                continue;
+            }
+            Connection& conn = it->second;
+            
+            if (events[i].events & EPOLLOUT) {
+                if (!flushOutput(loop, conn)) {
+                    continue;
+                }
+            }
+            if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+                handleReadable(loop, conn);
+            }
+        }
+        
+        if (reporter) {
+            uint64_t now = monotonicNs();
+            if (now - reporter->last_ns >= STATS_INTERVAL_MS * 1000000ULL) {
+                reportStats(self, *reporter, now);
+            }
+        }
+    }
+}
+
+// Função para criar o epoll de um loop e registrar um descritor de entrada
+bool initEventLoop(EventLoop& loop, int input_fd) {
+    loop.epoll_fd = epoll_create1(0);
+    if (loop.epoll_fd == -1) {
+        return false;
+    }
+    
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.fd = input_fd;
+    return epoll_ctl(loop.epoll_fd, EPOLL_CTL_ADD, input_fd, &ev) == 0;
+}
+
+// Thread de accept: distribui as conexões em round-robin entre os loops de
+// trabalho e agrega as estatísticas de todos eles
+void runAcceptLoop(int server_fd, const std::vector<EventLoop*>& workers) {
+    StatsReporter reporter;
+    reporter.last_ns = monotonicNs();
+    size_t next = 0;
+    
+    struct pollfd pfd;
+    pfd.fd = server_fd;
+    pfd.events = POLLIN;
+    
+    while (true) {
+        int ready = poll(&pfd, 1, STATS_INTERVAL_MS);
+        if (ready == -1 && errno != EINTR) {
+            logEvent("error", "Erro no poll do socket de escuta: " + std::string(strerror(errno)), "server");
+            return;
+        }
+        
+        while (ready > 0) {
+            int client_fd = accept(server_fd, NULL, NULL);
+            if (client_fd == -1) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                    logEvent("error", "Erro ao aceitar conexão: " + std::string(strerror(errno)), "server");
+                }
+                break;
+            }
+            
+            EventLoop* worker = workers[next];
+            next = (next + 1) % workers.size();
+            if (!handoffPush(worker->handoff, client_fd)) {
+                logEvent("error", "Fila de entrega da thread cheia, conexão recusada", "server");
+                close(client_fd);
+                continue;
+            }
+            uint64_t one = 1;
+            if (write(worker->wake_fd, &one, sizeof(one)) < 0 && errno != EAGAIN) {
+                logEvent("error", "Erro ao sinalizar thread de trabalho: " + std::string(strerror(errno)), "server");
+            }
+        }
+        
+        uint64_t now = monotonicNs();
+        if (now - reporter.last_ns >= STATS_INTERVAL_MS * 1000000ULL) {
+            reportStats(workers, reporter, now);
+        }
+    }
+}
+
+// Operações em voo no io_uring; o user_data guarda a operação e o descritor
+enum UringOp {
+    URING_OP_ACCEPT = 1,
+    URING_OP_READ,
+    URING_OP_WRITE,
+    URING_OP_CLOSE,
+    URING_OP_TIMER
+};
+
+// Estado do engine io_uring: um anel por loop, conexões e contadores no EventLoop
+struct UringEngine {
+    UringQueue ring;
+    EventLoop* loop;
+    char* buffers;                  // região registrada com URING_BUFFER_SLOTS fatias
+    std::vector<int> free_slots;
+    struct __kernel_timespec stats_interval;
+    bool multishot_accept;          // falso em kernels anteriores ao 5.19 (accept simples)
+    
+    UringEngine() : loop(nullptr), buffers(nullptr), multishot_accept(true) {
+        stats_interval.tv_sec = STATS_INTERVAL_MS / 1000;
+        stats_interval.tv_nsec = (STATS_INTERVAL_MS % 1000) * 1000000LL;
+    }
+};
+
+uint64_t uringTag(UringOp op, int fd) {
+    return ((uint64_t)op << 32) | (uint32_t)fd;
+}
+
+// Função para criar o anel e registrar os buffers de leitura.
+// Retorna false (com errno) quando o kernel não oferece io_uring ou alguma
+// das operações usadas pelo engine.
+bool initUringEngine(UringEngine& engine, EventLoop& loop) {
+    if (!uringInit(engine.ring, URING_ENTRIES)) {
+        return false;
+    }
+    static const int required_ops[] = {IORING_OP_ACCEPT, IORING_OP_READ, IORING_OP_READ_FIXED,
+                                       IORING_OP_WRITE, IORING_OP_CLOSE, IORING_OP_TIMEOUT};
+    if (!uringProbeOps(engine.ring, required_ops, sizeof(required_ops) / sizeof(required_ops[0]))) {
+        int saved = errno;
+        uringClose(engine.ring);
+        errno = saved;
+        return false;
+    }
+    
+    size_t region = (size_t)URING_BUFFER_SLOTS * URING_SLOT_SIZE;
+    void* buffers = mmap(NULL, region, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (buffers == MAP_FAILED) {
+        uringClose(engine.ring);
+        return false;
+    }
+    placementBindMemory(buffers, region, "server");
+    
+    struct iovec iov;
+    iov.iov_base = buffers;
+    iov.iov_len = region;
+    if (!uringRegisterBuffers(engine.ring, &iov, 1)) {
+        int saved = errno;
+        munmap(buffers, region);
+        uringClose(engine.ring);
+        errno = saved;
+        return false;
+    }
+    
+    engine.buffers = static_cast<char*>(buffers);
+    engine.loop = &loop;
+    for (int i = URING_BUFFER_SLOTS - 1; i >= 0; i--) {
+        engine.free_slots.push_back(i);
+    }
+    return true;
+}
+
+// Função para obter uma SQE; se o anel estiver cheio mesmo após submeter, aborta
+struct io_uring_sqe* uringSqe(UringEngine& engine) {
+    struct io_uring_sqe* sqe = uringGetSqe(engine.ring);
+    if (!sqe) {
+        logEvent("error", "Anel de submissão do io_uring cheio", "server");
+        abort();
+    }
+    return sqe;
+}
+
+// Accept multishot: uma única SQE gera uma conclusão por conexão aceita
+// (sem suporte no kernel, uma SQE por conexão)
+void uringQueueAccept(UringEngine& engine) {
+    struct io_uring_sqe* sqe = uringSqe(engine);
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = engine.loop->listen_fd;
+    sqe->ioprio = engine.multishot_accept ? IORING_ACCEPT_MULTISHOT : 0;
+    sqe->user_data = uringTag(URING_OP_ACCEPT, engine.loop->listen_fd);
+}
+
+// Timer que acorda o loop para emitir as estatísticas
+void uringQueueTimer(UringEngine& engine) {
+    struct io_uring_sqe* sqe = uringSqe(engine);
+    sqe->opcode = IORING_OP_TIMEOUT;
+    sqe->fd = -1;
+    sqe->addr = (uint64_t)(uintptr_t)&engine.stats_interval;
+    sqe->len = 1;
+    sqe->user_data = uringTag(URING_OP_TIMER, 0);
+}
+
+void uringQueueRead(UringEngine& engine, Connection& conn) {
+    struct io_uring_sqe* sqe = uringSqe(engine);
+    sqe->fd = conn.fd;
+    if (conn.buffer_slot >= 0) {
+        sqe->opcode = IORING_OP_READ_FIXED;
+        sqe->addr = (uint64_t)(uintptr_t)(engine.buffers + (size_t)conn.buffer_slot * URING_SLOT_SIZE);
+        sqe->len = URING_SLOT_SIZE;
+        sqe->buf_index = 0;
+    } else {
+        sqe->opcode = IORING_OP_READ;
+        sqe->addr = (uint64_t)(uintptr_t)conn.read_buffer.data();
+        sqe->len = conn.read_buffer.size();
+    }
+    sqe->user_data = uringTag(URING_OP_READ, conn.fd);
+    conn.read_pending = true;
+}
+
+// Função para enviar o lote pendente; outbuf só é movido para sending
+// quando não há escrita em voo, então o buffer nunca muda sob o kernel
+void uringQueueWrite(UringEngine& engine, Connection& conn) {
+    if (conn.write_pending) {
+        return;
+    }
+    if (conn.out_offset >= conn.sending.size()) {
+        if (conn.outbuf.empty()) {
+            return;
+        }
+        conn.sending.swap(conn.outbuf);
+        conn.outbuf.clear();
+        conn.out_offset = 0;
+    }
+    
+    struct io_uring_sqe* sqe = uringSqe(engine);
+    sqe->opcode = IORING_OP_WRITE;
+    sqe->fd = conn.fd;
+    sqe->addr = (uint64_t)(uintptr_t)(conn.sending.data() + conn.out_offset);
+    sqe->len = conn.sending.size() - conn.out_offset;
+    sqe->user_data = uringTag(URING_OP_WRITE, conn.fd);
+    conn.write_pending = true;
+}
+
+// Função para fechar a conexão quando não restam operações em voo
+void uringMaybeClose(UringEngine& engine, Connection& conn) {
+    if (!conn.closing || conn.read_pending || conn.write_pending) {
+        return;
+    }
+    
+    struct io_uring_sqe* sqe = uringSqe(engine);
+    sqe->opcode = IORING_OP_CLOSE;
+    sqe->fd = conn.fd;
+    sqe->user_data = uringTag(URING_OP_CLOSE, conn.fd);
+    
+    EventLoop& loop = *engine.loop;
+    int client_id = conn.client_id;
+    if (conn.buffer_slot >= 0) {
+        engine.free_slots.push_back(conn.buffer_slot);
+    }
+    loop.connections.erase(conn.fd);
+    loop.open_connections.fetch_sub(1, std::memory_order_relaxed);
+    logEvent("connection", "Conexão com cliente fechada", "server", client_id);
+}
+
+void uringAddClient(UringEngine& engine, int client_fd) {
+    EventLoop& loop = *engine.loop;
+    Connection& conn = loop.connections[client_fd];
+    conn.fd = client_fd;
+    conn.client_id = ++client_counter;
+    if (!engine.free_slots.empty()) {
+        conn.buffer_slot = engine.free_slots.back();
+        engine.free_slots.pop_back();
+    } else {
+        conn.read_buffer.resize(BUFFER_SIZE);
+    }
+    
+    loop.open_connections.fetch_add(1, std::memory_order_relaxed);
+    logEvent("connection", "Cliente conectado", "server", conn.client_id);
+    uringQueueRead(engine, conn);
+}
+
+void uringHandleRead(UringEngine& engine, Connection& conn, int res) {
+    conn.read_pending = false;
+    
+    if (res > 0) {
+        const char* data = conn.buffer_slot >= 0
+            ? engine.buffers + (size_t)conn.buffer_slot * URING_SLOT_SIZE
+            : conn.read_buffer.data();
+        conn.inbuf.append(data, res);
+        if (!processInput(*engine.loop, conn)) {
+            conn.closing = true;
+        }
+        uringQueueWrite(engine, conn);
+        if (!conn.closing) {
+            uringQueueRead(engine, conn);
+        }
+        uringMaybeClose(engine, conn);
+        return;
+    }
+    
+    if (res == -EINTR || res == -EAGAIN) {
+        uringQueueRead(engine, conn);
+        return;
+    }
+    
+    if (res < 0) {
+        logEvent("error", "Erro ao ler do cliente: " + std::string(strerror(-res)), "server", conn.client_id);
+    } else if (processInput(*engine.loop, conn)) {
+        uringQueueWrite(engine, conn);
+    }
+    conn.closing = true;
+    uringMaybeClose(engine, conn);
+}
+
+void uringHandleWrite(UringEngine& engine, Connection& conn, int res) {
+    conn.write_pending = false;
+    
+    if (res < 0) {
+        logEvent("error", "Erro ao enviar resposta: " + std::string(strerror(-res)), "server", conn.client_id);
+        conn.closing = true;
+        conn.sending.clear();
+        conn.outbuf.clear();
+        conn.out_offset = 0;
+        if (conn.read_pending) {
+            // Faz a leitura em voo concluir para liberar a conexão
+            shutdown(conn.fd, SHUT_RDWR);
+        }
+        uringMaybeClose(engine, conn);
+        return;
+    }
+    
+    conn.out_offset += res;
+    if (conn.out_offset >= conn.sending.size()) {
+        conn.sending.clear();
+        conn.out_offset = 0;
+    }
+    uringQueueWrite(engine, conn);
+    uringMaybeClose(engine, conn);
+}
+
+// Loop do engine io_uring: submissões e conclusões em lote, uma chamada
+// io_uring_enter por iteração em vez de uma syscall por operação
+void runUringLoop(UringEngine& engine) {
+    EventLoop& loop = *engine.loop;
+    StatsReporter reporter;
+    std::vector<EventLoop*> self(1, &loop);
+    reporter.last_ns = monotonicNs();
+    
+    uringQueueAccept(engine);
+    uringQueueTimer(engine);
+    
+    while (true) {
+        uint64_t enters_before = engine.ring.enter_calls;
+        if (uringSubmit(engine.ring, 1) < 0 && errno != EINTR && errno != EBUSY) {
+            logEvent("error", "Erro no io_uring_enter: " + std::string(strerror(errno)), "server");
+            return;
+        }
+        loop.syscalls.fetch_add(engine.ring.enter_calls - enters_before, std::memory_order_relaxed);
+        
+        struct io_uring_cqe* cqe;
+        while ((cqe = uringPeekCqe(engine.ring)) != nullptr) {
+            uint64_t tag = cqe->user_data;
+            int res = cqe->res;
+            unsigned flags = cqe->flags;
+            uringCqeSeen(engine.ring);
+            
+            UringOp op = (UringOp)(tag >> 32);
+            int fd = (int)(uint32_t)tag;
+            
+            if (op == URING_OP_ACCEPT) {
+                if (res >= 0) {
+                    uringAddClient(engine, res);
+                } else if (res == -EINVAL && engine.multishot_accept) {
+                    // Kernels 5.1-5.18 rejeitam IORING_ACCEPT_MULTISHOT
+                    engine.multishot_accept = false;
+                    logEvent("warning", "Kernel sem accept multishot, usando accept simples", "server");
+                } else if (res == -EINVAL) {
+                    logEvent("error", "Accept do io_uring rejeitado pelo kernel: " + std::string(strerror(-res)), "server");
+                    return;
+                } else if (res != -EAGAIN && res != -EINTR) {
+                    logEvent("error", "Erro ao aceitar conexão: " + std::string(strerror(-res)), "server");
+                }
+                if (!(flags & IORING_CQE_F_MORE)) {
+                    uringQueueAccept(engine);
+                }
+                continue;
+            }
+            if (op == URING_OP_TIMER) {
+                uint64_t now = monotonicNs();
+                if (now - reporter.last_ns >= STATS_INTERVAL_MS * 1000000ULL) {
+                    reportStats(self, reporter, now);
+                }
+                uringQueueTimer(engine);
+                continue;
+            }
+            if (op == URING_OP_CLOSE) {
+                continue;
+            }
+            
+            std::unordered_map<int, Connection>::iterator it = loop.connections.find(fd);
+            if (it == loop.connections.end()) {
+                continue;
+            }
+            if (op == URING_OP_READ) {
+                uringHandleRead(engine, it->second, res);
+            } else if (op == URING_OP_WRITE) {
+                uringHandleWrite(engine, it->second, res);
+            }
+        }
+    }
+}
+
+// Thread de controle: o servidor não tem loop de comandos, então os comandos
+// de tempo de execução (loglevel, stats, wait) chegam pela entrada padrão nesta thread
+void runControlThread() {
+    std::string command;
+    while (std::getline(std::cin, command)) {
+        if (command == "loglevel" || command.find("loglevel ") == 0) {
+            logLevelCommand(command.substr(8));
+        } else if (command == "stats" || command.find("stats ") == 0) {
+            spanCommand(command.substr(5), "server");
+        } else if (command == "wait" || command.find("wait ") == 0) {
+            waitCommand(command.substr(4), "server");
+        } else if (command == "topology") {
+            placementTopologyCommand("server");
+        } else if (!command.empty()) {
+            logEvent("error", "Comando não reconhecido: " + command, "server");
+        }
+    }
+}
+
+// Função para elevar o limite de descritores abertos ao máximo permitido
+void raiseFileLimit() {
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+}
+
+// Função para processar as opções de linha de comando
+bool parseArguments(int argc, char* argv[], int& threads, bool& use_uring) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        std::string value;
+        
+        if (arg == "--engine=uring" || arg == "--engine=epoll") {
+            use_uring = arg == "--engine=uring";
+            continue;
+        } else if (arg == "--threads" && i + 1 < argc) {
+            value = argv[++i];
+        } else if (arg.find("--threads=") == 0) {
+            value = arg.substr(10);
+        } else {
+            logEvent("error", "Opção não reconhecida: " + arg, "server", -1,
+                     "uso: server [--threads N] [--engine=epoll|uring]");
+            return false;
+        }
+        
+        threads = atoi(value.c_str());
+        if (threads < 1) {
+            logEvent("error", "Número de threads inválido: " + value, "server");
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    logInit(argc, argv);
+    spanInit(argc, argv);
+    placementInit(argc, argv, "server");
+    waitInit(argc, argv);
+    
+    int server_fd;
+    struct sockaddr_un server_addr;
+    int threads = 1;
+    bool use_uring = false;
+    
+    if (!parseArguments(argc, argv, threads, use_uring)) {
+        return 1;
+    }
+    
+    // O engine io_uring usa um único anel; sem io_uring volta para o epoll
+    UringEngine* engine = nullptr;
+    EventLoop* uring_loop = nullptr;
+    if (use_uring) {
+        if (threads > 1) {
+            logEvent("warning", "Engine io_uring usa um único loop, --threads ignorado", "server");
+            threads = 1;
+        }
+        engine = new UringEngine();
+        uring_loop = new EventLoop();
+        if (!initUringEngine(*engine, *uring_loop)) {
+            logEvent("warning", "io_uring indisponível, usando epoll: " + std::string(strerror(errno)), "server");
+            delete engine;
+            delete uring_loop;
+            engine = nullptr;
+            use_uring = false;
+        }
+    }
+    
+    logEvent("system", "Servidor iniciando", "server", -1,
+             "threads=" + std::to_string(threads) + " engine=" + (use_uring ? "uring" : "epoll") +
+             " " + placementSummary());
+    
+    // Escritas em conexões fechadas pelo cliente não devem encerrar o servidor
+    signal(SIGPIPE, SIG_IGN);
+    raiseFileLimit();
     
     // Criar socket
     server_fd = socket(AF_UNIX, SOCK_STREAM, 0);
@@ -73,52 +982,64 @@ int main() {
     }
     logEvent("socket", "Bind realizado com sucesso", "server", -1, SOCKET_PATH);
     
-    // Listen
-    if (listen(server_fd, 5) == -1) {
+    // Listen (o accept do io_uring espera no kernel, então o socket só é
+    // não-bloqueante no engine epoll)
+    if (listen(server_fd, SOMAXCONN) == -1 || (!use_uring && !setNonBlocking(server_fd))) {
         logEvent("error", "Erro no listen", "server");
         close(server_fd);
         return 1;
     }
     logEvent("socket", "Servidor ouvindo conexões", "server");
+    std::thread(runControlThread).detach();
     
-    int client_counter = 0;
-    
-    while (true) {
-        logEvent("socket", "Aguardando conexão de cliente...", "server");
+    if (use_uring) {
+        uring_loop->listen_fd = server_fd;
+        logEvent("socket", "Aguardando conexões de clientes (io_uring)...", "server");
+        runUringLoop(*engine);
+    } else if (threads == 1) {
+        EventLoop* loop = new EventLoop();
+        loop->listen_fd = server_fd;
+        if (!initEventLoop(*loop, server_fd)) {
+            logEvent("error", "Erro ao criar epoll: " + std::string(strerror(errno)), "server");
+            close(server_fd);
+            return 1;
+        }
         
-        // Aceitar conexão
-        client_fd = accept(server_fd, (struct sockaddr*)&client_addr, &client_len);
-        if (client_fd == -1) {
-            logEvent("error", "Erro ao aceitar conexão", "server");
-            continue;
+        logEvent("socket", "Aguardando conexões de clientes (epoll)...", "server");
+        StatsReporter reporter;
+        runEventLoop(*loop, &reporter);
+    } else {
+        // Uma thread por loop de trabalho, cada uma com seu próprio epoll
+        std::vector<EventLoop*> workers;
+        std::vector<std::thread> pool;
+        for (int i = 0; i < threads; i++) {
+            EventLoop* worker = new EventLoop();
+            worker->wake_fd = eventfd(0, EFD_NONBLOCK);
+            if (worker->wake_fd == -1 || !initEventLoop(*worker, worker->wake_fd)) {
+                logEvent("error", "Erro ao criar loop de trabalho: " + std::string(strerror(errno)), "server");
+                close(server_fd);
+                return 1;
+            }
+            workers.push_back(worker);
+            // Worker i usa a CPU i + 1 da lista --cpu (a 0 fica com o accept)
+            pool.push_back(std::thread([worker, i]() {
+                placementApply(i + 1, "server");
+                runEventLoop(*worker, nullptr);
+            }));
         }
         
-        client_counter++;
-        logEvent("connection", "Cliente conectado", "server", client_counter);
+        logEvent("socket", "Aguardando conexões de clientes (epoll)...", "server", -1,
+                 "threads=" + std::to_string(threads));
+        runAcceptLoop(server_fd, workers);
         
-        // Ler dados do cliente
-        ssize_t bytes_read = read(client_fd, buffer, BUFFER_SIZE - 1);
-        if (bytes_read > 0) {
-            buffer[bytes_read] = '\0';
-            logEvent("receive", "Mensagem recebida do cliente", "server", client_counter, buffer);
-            
-            // Processar mensagem (echo)
-            std::string response = "ECHO: ";
-            response += buffer;
-            
-            // Enviar resposta
-            write(client_fd, response.c_str(), response.length());
-            logEvent("send", "Resposta enviada para cliente", "server", client_counter, response);
+        for (size_t i = 0; i < pool.size(); i++) {
+            pool[i].detach();
         }
-        
-        // Fechar conexão com cliente
-        close(client_fd);
-        logEvent("connection", "Conexão com cliente fechada", "server", client_counter);
     }
     
-    // Fechar socket do servidor (não alcançável neste loop infinito)
+    // Fechar socket do servidor (alcançado apenas em erro do loop)
     close(server_fd);
     unlink(SOCKET_PATH);
     
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,405 @@
+#include <iostream>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <cstring>
+#include <ctime>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+#include <deque>
+#include "protocol.h"
+#include "log.h"
+#include "histogram.h"
+
+#define SOCKET_PATH "/tmp/demo_socket"
+#define READ_CHUNK_SIZE 65536
+#define MAX_EVENTS 256
+#define PROGRESS_INTERVAL_NS 1000000000ULL
+
+// Função para log em JSON
+void logEvent(const std::string& type, const std::string& message, 
+              const std::string& component = "", const std::string& data = "") {
+    if (!logAccept(type)) {
+        return;
+    }
+    LogLine& line = logBegin(type);
+    logString(line, "component", component);
+    logString(line, "message", message);
+    if (!data.empty()) {
+        logString(line, "data", data);
+    }
+    logEnd(line);
+}
+
+// Parâmetros da carga
+struct BenchConfig {
+    int connections;
+    size_t message_size;
+    double rate;            // requisições/s no total; 0 = malha fechada
+    double duration_s;
+    int pipeline;           // requisições em voo por conexão (malha fechada)
+    std::string server_path;
+    
+    BenchConfig() : connections(1), message_size(64), rate(0), duration_s(5),
+                   pipeline(1), server_path(SOCKET_PATH) {}
+};
+
+// Conexão de carga: as respostas chegam na ordem dos envios,
+// então uma fila de horários basta para casar cada resposta
+struct BenchConnection {
+    int fd;
+    std::string inbuf;
+    std::string outbuf;
+    size_t out_offset;
+    bool want_write;
+    std::deque<uint64_t> inflight_ns;   // horário (previsto) de cada requisição em voo
+    uint64_t next_request_id;
+    
+    BenchConnection() : fd(-1), out_offset(0), want_write(false), next_request_id(1) {}
+};
+
+struct BenchState {
+    BenchConfig config;
+    int epoll_fd;
+    std::vector<BenchConnection> connections;
+    std::string payload;
+    Histogram latency;          // execução inteira
+    Histogram interval;         // desde o último relatório de progresso
+    uint64_t sent;
+    uint64_t received;
+    uint64_t errors;
+    
+    BenchState() : epoll_fd(-1), sent(0), received(0), errors(0) {}
+};
+
+BenchState bench;
+
+// Função para obter tempo monotônico em nanossegundos
+uint64_t monotonicNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// Função para formatar os percentis de um histograma em microssegundos
+std::string formatLatency(const Histogram& h) {
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(1)
+       << "p50_us=" << histogramPercentile(h, 50) / 1e3
+       << " p99_us=" << histogramPercentile(h, 99) / 1e3
+       << " p999_us=" << histogramPercentile(h, 99.9) / 1e3
+       << " max_us=" << h.max / 1e3
+       << " mean_us=" << histogramMean(h) / 1e3;
+    return ss.str();
+}
+
+// Função para atualizar os eventos de interesse da conexão
+void updateInterest(BenchConnection& conn, bool want_write) {
+    if (conn.want_write == want_write) {
+        return;
+    }
+    struct epoll_event ev;
+    ev.events = EPOLLIN | (want_write ? EPOLLOUT : 0);
+    ev.data.ptr = &conn;
+    epoll_ctl(bench.epoll_fd, EPOLL_CTL_MOD, conn.fd, &ev);
+    conn.want_write = want_write;
+}
+
+// Função para enviar o que estiver pendente; retorna false em erro
+bool flushOutput(BenchConnection& conn) {
+    while (conn.out_offset < conn.outbuf.size()) {
+        ssize_t n = write(conn.fd, conn.outbuf.data() + conn.out_offset,
+                          conn.outbuf.size() - conn.out_offset);
+        if (n > 0) {
+            conn.out_offset += n;
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            updateInterest(conn, true);
+            return true;
+        } else {
+            return false;
+        }
+    }
+    conn.outbuf.clear();
+    conn.out_offset = 0;
+    updateInterest(conn, false);
+    return true;
+}
+
+// Função para enfileirar uma requisição; scheduled_ns é o horário previsto
+// de envio, de modo que atrasos do próprio gerador entram na latência
+void queueRequest(BenchConnection& conn, uint64_t scheduled_ns) {
+    appendFrame(conn.outbuf, conn.next_request_id++, bench.payload.data(), bench.payload.size());
+    conn.inflight_ns.push_back(scheduled_ns);
+    bench.sent++;
+}
+
+// Função para ler as respostas disponíveis e registrar as latências.
+// Retorna quantas respostas completaram, ou -1 se a conexão falhou.
+int handleReadable(BenchConnection& conn) {
+    char buffer[READ_CHUNK_SIZE];
+    while (true) {
+        ssize_t n = read(conn.fd, buffer, sizeof(buffer));
+        if (n > 0) {
+            conn.inbuf.append(buffer, n);
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        } else {
+            return -1;
+        }
+    }
+    
+    uint64_t now = monotonicNs();
+    size_t offset = 0;
+    int completed = 0;
+    while (true) {
+        FrameHeader header;
+        FrameStatus status = parseFrame(conn.inbuf, offset, header);
+        if (status == FRAME_INCOMPLETE) {
+            break;
+        }
+        if (status == FRAME_INVALID || conn.inflight_ns.empty()) {
+            return -1;
+        }
+        offset += sizeof(FrameHeader) + header.length;
+        
+        uint64_t latency = now - conn.inflight_ns.front();
+        conn.inflight_ns.pop_front();
+        histogramRecord(bench.latency, latency);
+        histogramRecord(bench.interval, latency);
+        bench.received++;
+        completed++;
+    }
+    conn.inbuf.erase(0, offset);
+    return completed;
+}
+
+// Função para abrir as conexões com o servidor
+bool openConnections() {
+    struct sockaddr_un server_addr;
+    memset(&server_addr, 0, sizeof(server_addr));
+    server_addr.sun_family = AF_UNIX;
+    strncpy(server_addr.sun_path, bench.config.server_path.c_str(), sizeof(server_addr.sun_path) - 1);
+    
+    bench.connections.resize(bench.config.connections);
+    for (size_t i = 0; i < bench.connections.size(); i++) {
+        BenchConnection& conn = bench.connections[i];
+        conn.fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (conn.fd == -1 ||
+            connect(conn.fd, (struct sockaddr*)&server_addr, sizeof(server_addr)) == -1) {
+            logEvent("error", "Erro ao conectar com servidor: " + std::string(strerror(errno)), "bench",
+                     "connection=" + std::to_string(i));
+            return false;
+        }
+        
+        int flags = fcntl(conn.fd, F_GETFL, 0);
+        fcntl(conn.fd, F_SETFL, flags | O_NONBLOCK);
+        
+        struct epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.ptr = &conn;
+        epoll_ctl(bench.epoll_fd, EPOLL_CTL_ADD, conn.fd, &ev);
+    }
+    return true;
+}
+
+// Função para emitir o progresso do último intervalo
+void reportProgress(double seconds) {
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(1)
+       << "requests_per_sec=" << bench.interval.total / seconds
+       << " " << formatLatency(bench.interval);
+    logEvent("stats", "Progresso do benchmark", "bench", ss.str());
+    histogramReset(bench.interval);
+}
+
+// Loop de carga: em malha fechada cada resposta libera uma nova requisição;
+// com --rate as requisições seguem um cronograma fixo (malha aberta)
+void runBench() {
+    struct epoll_event events[MAX_EVENTS];
+    uint64_t start = monotonicNs();
+    uint64_t end = start + (uint64_t)(bench.config.duration_s * 1e9);
+    uint64_t last_progress = start;
+    double interval_ns = bench.config.rate > 0 ? 1e9 / bench.config.rate : 0;
+    double next_send = start;
+    size_t next_conn = 0;
+    
+    if (interval_ns == 0) {
+        for (size_t i = 0; i < bench.connections.size(); i++) {
+            for (int j = 0; j < bench.config.pipeline; j++) {
+                queueRequest(bench.connections[i], start);
+            }
+            flushOutput(bench.connections[i]);
+        }
+    }
+    
+    uint64_t now = start;
+    while (now < end) {
+        if (interval_ns > 0) {
+            // Enviar tudo que já venceu no cronograma, em round-robin
+            while (next_send <= now) {
+                BenchConnection& conn = bench.connections[next_conn];
+                next_conn = (next_conn + 1) % bench.connections.size();
+                queueRequest(conn, (uint64_t)next_send);
+                next_send += interval_ns;
+            }
+            for (size_t i = 0; i < bench.connections.size(); i++) {
+                if (!bench.connections[i].outbuf.empty() && !bench.connections[i].want_write) {
+                    flushOutput(bench.connections[i]);
+                }
+            }
+        }
+        
+        int timeout_ms = 100;
+        if (interval_ns > 0) {
+            // Acorda no próximo envio agendado, sem passar do fim da medição
+            double wake = next_send < end ? next_send : end;
+            timeout_ms = (int)((wake - now) / 1e6);
+        }
+        int n = epoll_wait(bench.epoll_fd, events, MAX_EVENTS, timeout_ms);
+        if (n == -1 && errno != EINTR) {
+            logEvent("error", "Erro no epoll_wait: " + std::string(strerror(errno)), "bench");
+            return;
+        }
+        
+        for (int i = 0; i < n; i++) {
+            BenchConnection& conn = *static_cast<BenchConnection*>(events[i].data.ptr);
+            if (events[i].events & EPOLLOUT) {
+                if (!flushOutput(conn)) {
+                    bench.errors++;
+                }
+            }
+            if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                int completed = handleReadable(conn);
+                if (completed < 0) {
+                    logEvent("error", "Conexão com servidor perdida", "bench");
+                    bench.errors++;
+                    return;
+                }
+                if (interval_ns == 0 && completed > 0) {
+                    uint64_t issued = monotonicNs();
+                    for (int j = 0; j < completed; j++) {
+                        queueRequest(conn, issued);
+                    }
+                    if (!conn.want_write && !flushOutput(conn)) {
+                        bench.errors++;
+                    }
+                }
+            }
+        }
+        
+        now = monotonicNs();
+        if (now - last_progress >= PROGRESS_INTERVAL_NS) {
+            reportProgress((now - last_progress) / 1e9);
+            last_progress = now;
+        }
+    }
+    
+    double elapsed_s = (monotonicNs() - start) / 1e9;
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(1)
+       << "connections=" << bench.config.connections
+       << " size=" << bench.config.message_size
+       << " rate=" << bench.config.rate
+       << " pipeline=" << bench.config.pipeline
+       << " duration_s=" << elapsed_s
+       << " requests=" << bench.received
+       << " requests_per_sec=" << bench.received / elapsed_s
+       << " mb_per_sec=" << bench.received * bench.config.message_size / elapsed_s / 1e6
+       << " unanswered=" << bench.sent - bench.received
+       << " errors=" << bench.errors
+       << " " << formatLatency(bench.latency);
+    logEvent("stats", "Resultado do benchmark", "bench", ss.str());
+}
+
+// Função para processar as opções de linha de comando (--opcao=valor)
+bool parseArguments(int argc, char* argv[]) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        size_t eq = arg.find('=');
+        std::string name = arg.substr(0, eq);
+        std::string value = eq == std::string::npos ? "" : arg.substr(eq + 1);
+        
+        if (name == "--connections") {
+            bench.config.connections = atoi(value.c_str());
+        } else if (name == "--size") {
+            bench.config.message_size = strtoull(value.c_str(), NULL, 10);
+        } else if (name == "--rate") {
+            bench.config.rate = atof(value.c_str());
+        } else if (name == "--duration") {
+            bench.config.duration_s = atof(value.c_str());
+        } else if (name == "--pipeline") {
+            bench.config.pipeline = atoi(value.c_str());
+        } else if (name == "--path" && !value.empty()) {
+            bench.config.server_path = value;
+        } else {
+            logEvent("error", "Opção não reconhecida: " + arg, "bench",
+                     "uso: socket_bench [--connections=C] [--size=B] [--rate=R] [--duration=S] [--pipeline=D] [--path=P]");
+            return false;
+        }
+    }
+    
+    if (bench.config.connections < 1 || bench.config.message_size < 1 ||
+        bench.config.message_size > MAX_ECHO_PAYLOAD || bench.config.rate < 0 ||
+        bench.config.duration_s <= 0 || bench.config.pipeline < 1) {
+        logEvent("error", "Parâmetros do benchmark inválidos", "bench");
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    logInit(argc, argv);
+    
+    if (!parseArguments(argc, argv)) {
+        return 1;
+    }
+    
+    signal(SIGPIPE, SIG_IGN);
+    
+    // Muitas conexões podem exceder o limite padrão de descritores
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+    
+    bench.payload.assign(bench.config.message_size, 'x');
+    bench.epoll_fd = epoll_create1(0);
+    if (bench.epoll_fd == -1) {
+        logEvent("error", "Erro ao criar epoll: " + std::string(strerror(errno)), "bench");
+        return 1;
+    }
+    
+    std::stringstream ss;
+    ss << "connections=" << bench.config.connections
+       << " size=" << bench.config.message_size
+       << " rate=" << bench.config.rate
+       << " duration_s=" << bench.config.duration_s
+       << " pipeline=" << bench.config.pipeline;
+    logEvent("system", "Benchmark de sockets iniciando", "bench", ss.str());
+    
+    if (!openConnections()) {
+        return 1;
+    }
+    
+    runBench();
+    
+    for (size_t i = 0; i < bench.connections.size(); i++) {
+        close(bench.connections[i].fd);
+    }
+    close(bench.epoll_fd);
+    return 0;
+}
@@ -0,0 +1,208 @@
+#ifndef SOCKETS_URING_H
+#define SOCKETS_URING_H
+
+// Interface mínima para io_uring via chamadas de sistema diretas (sem liburing),
+// compartilhada pelo servidor e pelo cliente
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <cstring>
+#include <cerrno>
+#include <cstdlib>
+
+#define URING_PROBE_OPS 256
+
+// Anéis de submissão e conclusão mapeados do kernel
+struct UringQueue {
+    int ring_fd;
+
+    unsigned* sq_head;
+    unsigned* sq_tail;
+    unsigned* sq_mask;
+    unsigned* sq_array;
+    struct io_uring_sqe* sqes;
+    unsigned sq_local_tail;     // SQEs preparadas, publicadas em uringSubmit
+    unsigned sq_submitted;      // último tail publicado ao kernel
+
+    unsigned* cq_head;
+    unsigned* cq_tail;
+    unsigned* cq_mask;
+    struct io_uring_cqe* cqes;
+
+    void* sq_ptr;
+    size_t sq_size;
+    void* cq_ptr;
+    size_t cq_size;
+    size_t sqes_size;
+    unsigned long long enter_calls;   // chamadas a io_uring_enter (para medir syscalls)
+
+    UringQueue() : ring_fd(-1), sq_head(nullptr), sq_tail(nullptr), sq_mask(nullptr),
+                  sq_array(nullptr), sqes(nullptr), sq_local_tail(0), sq_submitted(0),
+                  cq_head(nullptr), cq_tail(nullptr), cq_mask(nullptr), cqes(nullptr),
+                  sq_ptr(nullptr), sq_size(0), cq_ptr(nullptr), cq_size(0), sqes_size(0),
+                  enter_calls(0) {}
+};
+
+inline void uringClose(UringQueue& q) {
+    if (q.sqes) {
+        munmap(q.sqes, q.sqes_size);
+    }
+    if (q.cq_ptr && q.cq_ptr != q.sq_ptr) {
+        munmap(q.cq_ptr, q.cq_size);
+    }
+    if (q.sq_ptr) {
+        munmap(q.sq_ptr, q.sq_size);
+    }
+    if (q.ring_fd != -1) {
+        close(q.ring_fd);
+    }
+    q = UringQueue();
+}
+
+// Cria o anel; retorna false (com errno) se io_uring não estiver disponível
+inline bool uringInit(UringQueue& q, unsigned entries) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+
+    q.ring_fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+    if (q.ring_fd < 0) {
+        q.ring_fd = -1;
+        return false;
+    }
+
+    q.sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    q.cq_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap) {
+        q.sq_size = q.cq_size = q.sq_size > q.cq_size ? q.sq_size : q.cq_size;
+    }
+
+    q.sq_ptr = mmap(NULL, q.sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                    q.ring_fd, IORING_OFF_SQ_RING);
+    if (q.sq_ptr == MAP_FAILED) {
+        q.sq_ptr = nullptr;
+        uringClose(q);
+        return false;
+    }
+
+    if (single_mmap) {
+        q.cq_ptr = q.sq_ptr;
+    } else {
+        q.cq_ptr = mmap(NULL, q.cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                        q.ring_fd, IORING_OFF_CQ_RING);
+        if (q.cq_ptr == MAP_FAILED) {
+            q.cq_ptr = nullptr;
+            uringClose(q);
+            return false;
+        }
+    }
+
+    q.sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    void* sqes = mmap(NULL, q.sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      q.ring_fd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        uringClose(q);
+        return false;
+    }
+    q.sqes = static_cast<struct io_uring_sqe*>(sqes);
+
+    char* sq = static_cast<char*>(q.sq_ptr);
+    q.sq_head = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    q.sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    q.sq_mask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    q.sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+
+    char* cq = static_cast<char*>(q.cq_ptr);
+    q.cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    q.cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    q.cq_mask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    q.cqes = reinterpret_cast<struct io_uring_cqe*>(cq + params.cq_off.cqes);
+
+    q.sq_local_tail = q.sq_submitted = *q.sq_tail;
+    return true;
+}
+
+// Registra buffers fixos (evita mapear as páginas a cada operação)
+inline bool uringRegisterBuffers(UringQueue& q, const struct iovec* iovs, unsigned count) {
+    return syscall(__NR_io_uring_register, q.ring_fd, IORING_REGISTER_BUFFERS, iovs, count) == 0;
+}
+
+// Consulta as operações do kernel (IORING_REGISTER_PROBE, 5.6+). Retorna false
+// (errno = EOPNOTSUPP) se o probe não existir ou alguma operação faltar
+inline bool uringProbeOps(UringQueue& q, const int* ops, int count) {
+    size_t size = sizeof(struct io_uring_probe) + URING_PROBE_OPS * sizeof(struct io_uring_probe_op);
+    struct io_uring_probe* probe = static_cast<struct io_uring_probe*>(calloc(1, size));
+    if (!probe) {
+        return false;
+    }
+
+    bool supported = syscall(__NR_io_uring_register, q.ring_fd, IORING_REGISTER_PROBE,
+                             probe, URING_PROBE_OPS) == 0;
+    for (int i = 0; supported && i < count; i++) {
+        supported = ops[i] <= probe->last_op && (probe->ops[ops[i]].flags & IO_URING_OP_SUPPORTED);
+    }
+    free(probe);
+    if (!supported) {
+        errno = EOPNOTSUPP;
+    }
+    return supported;
+}
+
+// Publica as SQEs preparadas e, se wait_nr > 0, espera conclusões na mesma syscall
+// (SQEs que o kernel deixou no anel, como após uma falha de preparo, são reenviadas)
+inline int uringSubmit(UringQueue& q, unsigned wait_nr) {
+    unsigned to_submit = q.sq_local_tail - __atomic_load_n(q.sq_head, __ATOMIC_ACQUIRE);
+    __atomic_store_n(q.sq_tail, q.sq_local_tail, __ATOMIC_RELEASE);
+    q.sq_submitted = q.sq_local_tail;
+
+    if (to_submit == 0 && wait_nr == 0) {
+        return 0;
+    }
+
+    int rc;
+    do {
+        q.enter_calls++;
+        rc = (int)syscall(__NR_io_uring_enter, q.ring_fd, to_submit, wait_nr,
+                          wait_nr ? IORING_ENTER_GETEVENTS : 0, NULL, 0);
+        to_submit = 0;   // após EINTR as SQEs já foram consumidas
+    } while (rc < 0 && errno == EINTR && wait_nr > 0 &&
+             __atomic_load_n(q.cq_tail, __ATOMIC_ACQUIRE) == *q.cq_head);
+    return rc;
+}
+
+// Reserva uma SQE zerada; se o anel estiver cheio, submete o lote atual primeiro
+inline struct io_uring_sqe* uringGetSqe(UringQueue& q) {
+    unsigned head = __atomic_load_n(q.sq_head, __ATOMIC_ACQUIRE);
+    if (q.sq_local_tail - head > *q.sq_mask) {
+        uringSubmit(q, 0);
+        head = __atomic_load_n(q.sq_head, __ATOMIC_ACQUIRE);
+        if (q.sq_local_tail - head > *q.sq_mask) {
+            return nullptr;
+        }
+    }
+
+    unsigned index = q.sq_local_tail & *q.sq_mask;
+    struct io_uring_sqe* sqe = &q.sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    q.sq_array[index] = index;
+    q.sq_local_tail++;
+    return sqe;
+}
+
+// Retorna a próxima conclusão disponível (ou nullptr) sem chamar o kernel
+inline struct io_uring_cqe* uringPeekCqe(UringQueue& q) {
+    unsigned head = *q.cq_head;
+    if (head == __atomic_load_n(q.cq_tail, __ATOMIC_ACQUIRE)) {
+        return nullptr;
+    }
+    return &q.cqes[head & *q.cq_mask];
+}
+
+inline void uringCqeSeen(UringQueue& q) {
+    __atomic_store_n(q.cq_head, *q.cq_head + 1, __ATOMIC_RELEASE);
+}
+
+#endif
@@ -0,0 +1,259 @@
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <unordered_map>
+#include "log.h"
+
+// Decodificador do fluxo binário dos programas (--format=binary): lê o fluxo
+// da entrada padrão (ou de um arquivo) e escreve as mesmas linhas JSON que o
+// programa teria emitido no modo padrão.
+//
+// Uso:
+//     ./server --format=binary > trace.bin
+//     ./log_decode trace.bin | ...
+
+#define DECODE_READ_SIZE 65536
+
+// Estrutura para o estado do decodificador
+struct DecoderState {
+    std::unordered_map<uint32_t, std::string> strings;
+    std::string output;
+    time_t cached_second;
+    char cached_text[32];
+    uint64_t events;
+    uint64_t truncated;
+    
+    DecoderState() : cached_second(-1), events(0), truncated(0) {
+        cached_text[0] = '\0';
+    }
+};
+
+DecoderState decoder;
+
+// Função para escrever a saída acumulada
+void flushOutput() {
+    fwrite(decoder.output.data(), 1, decoder.output.size(), stdout);
+    decoder.output.clear();
+}
+
+// Função para obter o texto de um id (ou um marcador se a definição faltar)
+std::string lookupString(uint32_t id) {
+    std::unordered_map<uint32_t, std::string>::iterator found = decoder.strings.find(id);
+    if (found == decoder.strings.end()) {
+        return "#" + std::to_string(id);
+    }
+    return found->second;
+}
+
+// Função para formatar o timestamp como no modo JSON
+void appendTimestamp(uint64_t timestamp_ns) {
+    time_t second = (time_t)(timestamp_ns / 1000000000ULL);
+    if (second != decoder.cached_second) {
+        struct tm tm;
+        localtime_r(&second, &tm);
+        strftime(decoder.cached_text, sizeof(decoder.cached_text), "%Y-%m-%d %H:%M:%S", &tm);
+        decoder.cached_second = second;
+    }
+    char micros[8];
+    snprintf(micros, sizeof(micros), ".%06u", (unsigned)(timestamp_ns % 1000000000ULL / 1000));
+    decoder.output += decoder.cached_text;
+    decoder.output += micros;
+}
+
+void appendQuoted(const std::string& value) {
+    decoder.output += '"';
+    decoder.output += logEscape(value);
+    decoder.output += '"';
+}
+
+// Leitor sequencial do payload com verificação de limites
+struct PayloadReader {
+    const char* data;
+    size_t length;
+    size_t offset;
+    
+    PayloadReader(const char* data, size_t length) : data(data), length(length), offset(0) {}
+    
+    bool read(void* out, size_t size) {
+        if (length - offset < size) {
+            return false;
+        }
+        memcpy(out, data + offset, size);
+        offset += size;
+        return true;
+    }
+    
+    bool readString(std::string& out) {
+        uint32_t size;
+        if (!read(&size, sizeof(size)) || length - offset < size) {
+            return false;
+        }
+        out.assign(data + offset, size);
+        offset += size;
+        return true;
+    }
+};
+
+// Função para decodificar um evento; false se o payload estiver corrompido
+bool decodeEvent(const LogRecordHeader& header, const char* payload) {
+    PayloadReader reader(payload, header.length);
+    std::string type;
+    if (header.type_id != 0) {
+        type = lookupString(header.type_id);
+    } else if (!reader.readString(type)) {
+        return false;
+    }
+    
+    decoder.output += "{\"timestamp\":\"";
+    appendTimestamp(header.timestamp_ns);
+    decoder.output += "\",\"type\":";
+    appendQuoted(type);
+    
+    while (reader.offset < reader.length) {
+        uint32_t key_id;
+        std::string key;
+        uint8_t kind;
+        if (!reader.read(&key_id, sizeof(key_id))) {
+            return false;
+        }
+        if (key_id != 0) {
+            key = lookupString(key_id);
+        } else if (!reader.readString(key)) {
+            return false;
+        }
+        if (!reader.read(&kind, 1)) {
+            return false;
+        }
+        
+        std::string text;
+        int64_t number;
+        switch (kind) {
+            case LOG_VALUE_STRING:
+                if (!reader.readString(text)) {
+                    return false;
+                }
+                if (header.flags & LOG_RECORD_TRUNCATED && reader.offset == reader.length) {
+                    text += LOG_TRUNCATED_MARK;
+                }
+                decoder.output += ',';
+                appendQuoted(key);
+                decoder.output += ':';
+                appendQuoted(text);
+                break;
+            case LOG_VALUE_INT:
+                if (!reader.read(&number, sizeof(number))) {
+                    return false;
+                }
+                decoder.output += ',';
+                appendQuoted(key);
+                decoder.output += ':';
+                decoder.output += std::to_string(number);
+                break;
+            case LOG_VALUE_MESSAGE:
+                decoder.output += ',';
+                appendQuoted(key);
+                decoder.output += ':';
+                appendQuoted(lookupString(header.message_id));
+                break;
+            case LOG_VALUE_JSON_FIELDS:
+                if (!reader.readString(text)) {
+                    return false;
+                }
+                decoder.output += ',';
+                decoder.output += text;
+                break;
+            default:
+                return false;
+        }
+    }
+    
+    decoder.output += "}\n";
+    decoder.events++;
+    if (header.flags & LOG_RECORD_TRUNCATED) {
+        decoder.truncated++;
+    }
+    return true;
+}
+
+// Função para consumir os registros completos do buffer; retorna os bytes
+// consumidos ou -1 se o fluxo estiver corrompido
+long decodeBuffer(const std::string& buffer) {
+    size_t offset = 0;
+    
+    while (buffer.size() - offset >= sizeof(LogStreamHeader)) {
+        // Fluxos concatenados (ex.: várias execuções no mesmo arquivo)
+        if (memcmp(buffer.data() + offset, LOG_STREAM_MAGIC, 4) == 0) {
+            LogStreamHeader stream;
+            memcpy(&stream, buffer.data() + offset, sizeof(stream));
+            if (stream.version != LOG_STREAM_VERSION || stream.record_header_size != sizeof(LogRecordHeader)) {
+                fprintf(stderr, "log_decode: versão de fluxo não suportada (%u)\n", (unsigned)stream.version);
+                return -1;
+            }
+            offset += sizeof(stream);
+            continue;
+        }
+        
+        if (buffer.size() - offset < sizeof(LogRecordHeader)) {
+            break;
+        }
+        LogRecordHeader header;
+        memcpy(&header, buffer.data() + offset, sizeof(header));
+        if (header.length > LOG_LINE_CAPACITY) {
+            fprintf(stderr, "log_decode: registro inválido no byte %zu\n", offset);
+            return -1;
+        }
+        if (buffer.size() - offset - sizeof(header) < header.length) {
+            break;
+        }
+        
+        const char* payload = buffer.data() + offset + sizeof(header);
+        if (header.kind == LOG_RECORD_STRING) {
+            decoder.strings[header.message_id].assign(payload, header.length);
+        } else if (header.kind != LOG_RECORD_EVENT || !decodeEvent(header, payload)) {
+            fprintf(stderr, "log_decode: registro inválido no byte %zu\n", offset);
+            return -1;
+        }
+        offset += sizeof(header) + header.length;
+    }
+    return (long)offset;
+}
+
+int main(int argc, char* argv[]) {
+    FILE* input = stdin;
+    if (argc > 2 || (argc == 2 && argv[1][0] == '-' && argv[1][1] != '\0')) {
+        fprintf(stderr, "uso: log_decode [arquivo|-]\n");
+        return 1;
+    }
+    if (argc == 2 && strcmp(argv[1], "-") != 0) {
+        input = fopen(argv[1], "rb");
+        if (!input) {
+            fprintf(stderr, "log_decode: não foi possível abrir %s: %s\n", argv[1], strerror(errno));
+            return 1;
+        }
+    }
+    
+    std::string buffer;
+    char chunk[DECODE_READ_SIZE];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), input)) > 0) {
+        buffer.append(chunk, n);
+        long consumed = decodeBuffer(buffer);
+        if (consumed < 0) {
+            flushOutput();
+            return 1;
+        }
+        buffer.erase(0, (size_t)consumed);
+        flushOutput();
+        fflush(stdout);
+    }
+    
+    if (!buffer.empty()) {
+        fprintf(stderr, "log_decode: fluxo termina no meio de um registro (%zu bytes)\n", buffer.size());
+    }
+    fprintf(stderr, "log_decode: %llu eventos (%llu truncados), %zu strings\n",
+            (unsigned long long)decoder.events, (unsigned long long)decoder.truncated,
+            decoder.strings.size());
+    return buffer.empty() ? 0 : 1;
+}